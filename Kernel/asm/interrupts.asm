@@ -14,6 +14,7 @@ GLOBAL _irq05Handler
 GLOBAL _irq80Handler
 GLOBAL _exception0Handler
 GLOBAL _exception6Handler
+GLOBAL _exception14Handler
 
 GLOBAL process_start
 GLOBAL setup_process_context
@@ -24,6 +25,7 @@ EXTERN schedule
 
 EXTERN irqDispatcher
 EXTERN exceptionDispatcher
+EXTERN page_fault_handler
 EXTERN syscallDispatcher
 EXTERN getStackBase
 EXTERN timer_handler
@@ -114,8 +116,27 @@ picSlaveMask:
     retn
 
 
+; Las IRQ llegan por el stack IST: si el CPU apilara el frame en un stack de proceso sin pagina, el page fault
+; haria perder la interrupcion. Aca se copia el frame al stack del proceso con push comunes, que si fallan se
+; reintentan despues de que el page fault mapee la pagina.
+%macro irqFrameToProcessStack 0
+	push rax
+	push rbx
+	mov rbx, rsp			; [rbx] = rbx, [rbx+8] = rax, [rbx+16] = RIP, CS, RFLAGS, RSP, SS
+	mov rsp, [rbx + 40]
+	and rsp, -16
+	push qword [rbx + 48]
+	push qword [rbx + 40]
+	push qword [rbx + 32]
+	push qword [rbx + 24]
+	push qword [rbx + 16]
+	mov rax, [rbx + 8]
+	mov rbx, [rbx]
+%endmacro
+
 ;8254 Timer (Timer Tick)
 _irq00Handler:
+	irqFrameToProcessStack
 	pushState
 
     call timer_handler ;ticks++
@@ -246,6 +267,24 @@ _exception6Handler:
 	exceptionHandler 6
 	jmp haltcpu
 
+;Page fault: el CPU apila un codigo de error; se saca antes de armar el frame del scheduler
+_exception14Handler:
+	push rax
+	mov rax, [rsp + 8]
+	mov [pf_error], rax
+	pop rax
+	add rsp, 8
+
+	pushState
+
+	mov rdi, rsp
+	mov rsi, [pf_error]
+	call page_fault_handler
+	mov rsp, rax
+
+	popState
+	iretq
+
 
 haltcpu:
 	cli
@@ -317,6 +356,7 @@ setup_process_context:
 SECTION .bss
 	aux resq 1
 	exception_regs resq 18
+	pf_error resq 1
 
 SECTION .rodata
 	userland equ 0x400000
@@ -6,6 +6,18 @@ GLOBAL outw
 GLOBAL process_user_entry
 GLOBAL acquire
 GLOBAL release
+GLOBAL irq_save
+GLOBAL irq_restore
+GLOBAL read_cr2
+GLOBAL read_cr3
+GLOBAL write_cr3
+GLOBAL read_cr4
+GLOBAL write_cr4
+GLOBAL flush_tlb_page
+GLOBAL cpuid_ecx
+GLOBAL read_tsc
+GLOBAL load_gdt
+GLOBAL load_tr
 
 section .text
 	
@@ -91,4 +103,64 @@ acquire:
 
 release:
     mov byte [rdi], 0
-    ret
\ No newline at end of file
+    ret
+
+irq_save:
+    pushfq
+    pop rax
+    cli
+    ret
+
+irq_restore:
+    push rdi
+    popfq
+    ret
+
+read_cr2:
+    mov rax, cr2
+    ret
+
+read_cr3:
+    mov rax, cr3
+    ret
+
+write_cr3:
+    mov cr3, rdi
+    ret
+
+read_cr4:
+    mov rax, cr4
+    ret
+
+write_cr4:
+    mov cr4, rdi
+    ret
+
+flush_tlb_page:
+    invlpg [rdi]
+    ret
+
+; cpuid_ecx(leaf): ECX de CPUID con subleaf 0
+cpuid_ecx:
+    push rbx
+    mov eax, edi
+    xor ecx, ecx
+    cpuid
+    mov eax, ecx
+    pop rbx
+    ret
+
+read_tsc:
+    rdtsc
+    shl rdx, 32
+    or rax, rdx
+    ret
+
+; load_gdt(gdtr): los selectores no cambian, asi que no hace falta recargar CS ni los de datos
+load_gdt:
+    lgdt [rdi]
+    ret
+
+load_tr:
+    ltr di
+    ret
@@ -27,6 +27,7 @@ typedef struct CircleBuffer {
 
 static TCircleBuffer buffer = {.readIndex = 0, .writeIndex = 0, .size = 0};
 static uint64_t kbd_sem_id = 0;
+static wait_queue_t kbd_queue = {NULL}; // procesos en poll esperando teclas
 
 static const char scancode_table[KEY_COUNT][2] = {
 	{0, 0},		  {ESC, ESC}, {'1', '!'}, {'2', '@'},	{'3', '#'},	  {'4', '$'}, {'5', '%'},	{'6', '^'},
@@ -64,6 +65,7 @@ void keyboard_interrupt_handler() {
 			if (kbd_sem_id != 0) {
 				sem_signal_by_id(kbd_sem_id);
 			}
+			wait_queue_wake_all(&kbd_queue);
 		}
 	}
 	else if (cAscii != 0) {
@@ -71,6 +73,7 @@ void keyboard_interrupt_handler() {
 			if (kbd_sem_id != 0) {
 				sem_signal_by_id(kbd_sem_id);
 			}
+			wait_queue_wake_all(&kbd_queue);
 		}
 	}
 }
@@ -138,6 +141,14 @@ void keyboard_init(void) {
 	}
 }
 
+int keyboard_has_input(void) {
+	return !buffer_empty();
+}
+
+wait_queue_t *keyboard_wait_queue(void) {
+	return &kbd_queue;
+}
+
 void keyboard_wait_for_char(void) {
 	while (buffer_empty()) {
 		if (kbd_sem_id != 0) {
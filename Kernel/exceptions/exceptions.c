@@ -1,6 +1,9 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <exceptions.h>
+#include <interrupts.h>
+#include <paging.h>
+#include <scheduler.h>
 
 static void video_printRegister(char *regName, uint64_t regValue);
 static void video_printRegisters(uint64_t exceptionRegisters[18]);
@@ -28,6 +31,34 @@ void invalidOperation() {
 	video_newLine();
 }
 
+/*
+ * Corre en el stack IST. Si falta una pagina de un stack de kernel se mapea y se reintenta la instruccion.
+ * Si el contexto que fallo tenia las interrupciones habilitadas no estaba dentro del allocator (que las
+ * deshabilita), asi que puede pedir memoria; si no, solo usa la reserva de paginas en cero.
+ * Cualquier otro acceso (la ventana de otro proceso, la guarda de un stack) termina solo al proceso.
+ * Si falla el kernel fuera de un proceso (idle) no hay a quien culpar y se detiene la maquina.
+ */
+uint64_t page_fault_handler(uint64_t rsp, uint64_t error) {
+	uint64_t addr = read_cr2();
+	uint64_t rflags = ((uint64_t *) rsp)[17];
+	if (!(error & PF_ERROR_PRESENT) && paging_stack_fault(addr, (rflags & RFLAGS_IF) != 0))
+		return rsp;
+
+	process_t *p = scheduler_current_process();
+	video_printError("Error: Page fault");
+	video_newLine();
+	video_printRegister("CR2", addr);
+	video_printRegister("ERR", error);
+	video_printRegister("RIP", ((uint64_t *) rsp)[15]);
+
+	scheduler_finish_current();
+	if (!p || p->state == PROCESS_STATE_RUNNING)
+		haltcpu();
+	// Si el fallo fue copiando el frame del timer, su EOI no llega a mandarse; sin IRQ en servicio no hace nada
+	outb(PIC_MASTER_CMD, PIC_EOI);
+	return schedule(rsp);
+}
+
 void video_printRegister(char *regName, uint64_t regValue) {
 	video_putString(regName, 0xFFFFFF, 0x000000);
 	video_putString(": 0x", 0xFFFFFF, 0x000000);
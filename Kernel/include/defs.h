@@ -11,6 +11,8 @@
 #define ACS_IDT ACS_DSEG
 #define ACS_INT_386 0x0E /* Interrupt GATE 32 bits */
 #define ACS_INT (ACS_PRESENT | ACS_INT_386)
+#define ACS_TSS_386 0x09 /* TSS de 64 bits disponible */
+#define ACS_TSS (ACS_PRESENT | ACS_TSS_386)
 
 #define ACS_CODE (ACS_PRESENT | ACS_CSEG | ACS_READ)
 #define ACS_DATA (ACS_PRESENT | ACS_DSEG | ACS_WRITE)
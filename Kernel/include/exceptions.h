@@ -7,10 +7,17 @@
 
 #define ZERO_EXCEPTION_ID 0
 #define INVALID_OPCODE_ID 6
+#define PAGE_FAULT_ID 14
+#define PF_ERROR_PRESENT 0x1 // el fallo fue por permisos, no por una pagina ausente
+#define RFLAGS_IF 0x200
+#define PIC_MASTER_CMD 0x20
+#define PIC_EOI 0x20
 
 void zero_division();
 void invalidOperation();
 void exceptionDispatcher(int exception, uint64_t exceptionRegisters[18]);
 void printRegStatus(uint64_t exceptionRegisters[18]);
+// Termina al proceso que fallo y devuelve el rsp del siguiente (mismo contrato que schedule)
+uint64_t page_fault_handler(uint64_t rsp, uint64_t error);
 
 #endif
\ No newline at end of file
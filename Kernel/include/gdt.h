@@ -0,0 +1,23 @@
+#ifndef _GDT_H_
+#define _GDT_H_
+
+#include <stdint.h>
+
+// Selectores: los mismos de Pure64 mas el TSS
+#define GDT_CODE_SEL 0x08
+#define GDT_DATA_SEL 0x10
+#define GDT_TSS_SEL 0x18
+
+// Stack alternativo (IST) del page fault: atiende fallos aunque el stack del proceso no tenga pagina
+#define GDT_IST_PAGE_FAULT 1
+// Stack IST de las IRQ: el CPU nunca apila su frame en un stack de proceso que puede no tener pagina
+#define GDT_IST_IRQ 2
+#define GDT_IST_STACK_SIZE (4 * 4096)
+
+void load_gdt_tss(void);
+
+// libasm.asm
+void load_gdt(void *gdtr);
+void load_tr(uint16_t selector);
+
+#endif
@@ -15,6 +15,7 @@ void _irq80Handler(void);
 
 void _exception0Handler(void);
 void _exception6Handler(void);
+void _exception14Handler(void);
 
 void _cli(void);
 void _sti(void);
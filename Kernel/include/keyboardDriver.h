@@ -2,6 +2,7 @@
 #define KEYBOARDDRIVER_H
 
 #include <interrupts.h>
+#include <poll.h>
 #include <registers.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -53,6 +54,12 @@ void keyboard_init(void);
 /* Bloquea hasta que haya al menos un carácter disponible en el buffer */
 void keyboard_wait_for_char(void);
 
+/* Indica si hay caracteres en el buffer, sin consumirlos */
+int keyboard_has_input(void);
+
+/* Cola donde esperan los procesos bloqueados en poll sobre el teclado */
+wait_queue_t *keyboard_wait_queue(void);
+
 /* Limpia el buffer del teclado y resetea el semáforo
  * Se llama cuando se mata un proceso foreground con Ctrl+C */
 void keyboard_clear_buffer(void);
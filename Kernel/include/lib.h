@@ -6,8 +6,13 @@
 void *memset(void *destination, int32_t character, uint64_t length);
 void *memcpy(void *destination, const void *source, uint64_t length);
 char *cpuVendor(char *result);
+void outb(uint16_t port, uint8_t value);
 
 void acquire(volatile uint8_t *lock);
 void release(volatile uint8_t *lock);
 
+// Deshabilita interrupciones devolviendo RFLAGS previo; irq_restore lo repone
+uint64_t irq_save(void);
+void irq_restore(uint64_t flags);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef MEMORY_MAP_H
+#define MEMORY_MAP_H
+
+#include <stdint.h>
+
+// Pure64 deja el mapa E820 en 0x4000 (entradas de 32 bytes, termina en una entrada nula) y la RAM en MiB en mem_amount
+#define E820_MAP_ADDRESS 0x4000ULL
+#define E820_MAX_ENTRIES 256
+#define E820_TYPE_USABLE 1
+#define PURE64_MEM_AMOUNT_ADDRESS (0x5A00ULL + 132)
+
+// Pure64 solo mapea identidad los primeros 64 GiB (paginas de 2 MiB)
+#define MEMORY_MAP_MAPPED_LIMIT 0x1000000000ULL
+
+typedef struct {
+	uint64_t base;
+	uint64_t length;
+	uint32_t type;
+	uint32_t acpi_attributes;
+	uint64_t reserved;
+} e820_entry_t;
+
+typedef struct {
+	uint64_t start;
+	uint64_t end;
+} memory_region_t;
+
+/*
+ * Llena regions con las zonas usables del mapa E820 ordenadas por direccion, sin solapamientos,
+ * alineadas a pagina y recortadas a [reserved_end, MEMORY_MAP_MAPPED_LIMIT). Devuelve cuantas escribio.
+ */
+uint64_t memory_map_usable_regions(memory_region_t *regions, uint64_t max_regions, uint64_t reserved_end);
+// RAM total informada por el bootloader, en MiB
+uint64_t memory_map_total_mb(void);
+
+#endif
@@ -4,6 +4,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define MM_PAGE_SIZE 0x1000ULL
+#define MM_LARGE_PAGE_SIZE 0x200000ULL
+// Mayor alineacion que garantiza mm_alloc_aligned y mayor orden de mm_alloc_pages (2^9 paginas = 2 MB)
+#define MM_MAX_ALIGN MM_LARGE_PAGE_SIZE
+#define MM_MAX_PAGE_ORDER 9
+
 typedef struct {
 	uint64_t total_bytes;
 	uint64_t used_bytes;
@@ -12,14 +18,82 @@ typedef struct {
 	uint64_t allocations;
 	uint64_t frees;
 	uint64_t failed_allocations;
+	uint64_t internal_fragmentation; // bytes asignados de mas por redondeo de bloques (solo buddy)
+	uint64_t zeroed_bytes;			 // bytes libres ya puestos en cero por el proceso idle
+	uint64_t split_ops;				 // bloques partidos a la mitad (solo buddy)
+	uint64_t merge_ops;				 // uniones de un bloque con su buddy (solo buddy)
 } mm_stats_t;
 
+/*
+ * Interfaz de un memory manager (simple, buddy o tlsf). Cada backend tiene un unico estado interno, asi que
+ * puede haber tantos heaps simultaneos como backends; mm.c agrega los magazines y el lock delante de cada uno.
+ */
+typedef struct {
+	const char *name;
+	// Reinicia el backend con una unica region; add_region suma otras regiones disjuntas como arenas aparte
+	void (*init)(void *heap_start, uint64_t heap_size);
+	void (*add_region)(void *start, uint64_t size);
+	void *(*alloc)(uint64_t size);
+	void *(*alloc_aligned)(uint64_t size, uint64_t align);
+	void (*free)(void *ptr);
+	// Bytes utilizables del bloque asignado en ptr, o 0 si ptr no es un bloque asignado
+	uint64_t (*usable_size)(void *ptr);
+	void (*get_stats)(mm_stats_t *stats);
+	uint8_t (*is_initialized)(void);
+	// Trabajo diferido que el backend hace desde el idle (puede ser NULL); devuelve 0 si no hizo nada
+	int (*idle_step)(void);
+} mm_allocator_t;
+
+// El heap 0 usa el backend elegido con MM=; los otros dos backends arman heaps chicos de MM_SECONDARY_HEAP_SIZE
+#define MM_MAX_HEAPS 3
+#define MM_SECONDARY_HEAP_SIZE (16ULL * 1024 * 1024)
+
+// Para que se usa cada pedido: cada uso se asigna a un heap y se puede cambiar en runtime
+typedef enum {
+	MM_USE_GENERAL = 0, // mm_alloc, mm_alloc_aligned, mm_alloc_zeroed
+	MM_USE_STACKS,		// stacks de kernel de los procesos
+	MM_USE_PAGES,		// mm_alloc_pages y slabs de los caches
+	MM_USE_USER,		// regiones del heap de usuario
+	MM_USE_COUNT
+} mm_use_t;
+
 void mm_init(void *heap_start, uint64_t heap_size);
 void mm_init_default(void);
 void *mm_alloc(uint64_t size);
+// align debe ser potencia de 2 y <= MM_MAX_ALIGN; el bloque se libera con mm_free
+void *mm_alloc_aligned(uint64_t size, uint64_t align);
+// 2^order paginas contiguas alineadas a su tamaño
+void *mm_alloc_pages(uint8_t order);
+void mm_free_pages(void *ptr);
 void mm_free(void *ptr);
+// Memoria en cero: sale del pool pre-cerado si hay un bloque de la clase, si no hace el memset.
+// Los pedidos de una pagina o mas salen alineados a pagina (las regiones de usuario se mapean por pagina)
+void *mm_alloc_zeroed(uint64_t size);
+// Llamado por el proceso idle: pre-cera un bloque; devuelve 0 si no habia nada que hacer
+int mm_idle_zero_step(void);
+// Llamado por el proceso idle: trabajo diferido de los backends; devuelve 0 si no habia nada que hacer
+int mm_idle_trim_step(void);
+void *mm_alloc_for(mm_use_t use, uint64_t size);
+void *mm_alloc_aligned_for(mm_use_t use, uint64_t size, uint64_t align);
+void *mm_alloc_zeroed_for(mm_use_t use, uint64_t size);
+// Suma de todos los heaps
 void mm_get_stats(mm_stats_t *stats);
 uint8_t mm_is_initialized(void);
+// Backend del heap 0
 const char *mm_get_manager_name(void);
 
+#define MM_HEAP_NAME_LEN 16
+
+typedef struct {
+	char name[MM_HEAP_NAME_LEN]; // backend del heap
+	uint64_t uses;				 // bit (1 << uso) por cada mm_use_t asignado al heap
+	mm_stats_t stats;
+} mm_heap_info_t;
+
+int mm_heap_count(void);
+// Copia hasta max_count heaps a buffer; devuelve cuantos copio
+uint64_t mm_get_heap_info(mm_heap_info_t *buffer, uint64_t max_count);
+// Los bloques ya entregados se siguen liberando en su heap; devuelve 0 si el uso o el heap no existen
+int mm_set_use_heap(mm_use_t use, int heap);
+
 #endif
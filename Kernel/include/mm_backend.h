@@ -0,0 +1,20 @@
+#ifndef MM_BACKEND_H
+#define MM_BACKEND_H
+
+#include <mm.h>
+
+/*
+ * Backends disponibles. Solo los usa mm.c, que arma los heaps y agrega los caches por CPU y el lock;
+ * el resto del kernel usa mm.h.
+ */
+extern const mm_allocator_t mm_simple_allocator;
+extern const mm_allocator_t mm_buddy_allocator;
+extern const mm_allocator_t mm_tlsf_allocator;
+
+// Regiones por heap: mm.c no le pasa mas que esto a un backend, y los backends con arenas fijas reservan tantas
+#define MM_MAX_REGIONS 16
+
+// Backend del heap, o NULL si el heap no existe
+const mm_allocator_t *mm_heap_allocator(int heap);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MM_PROFILE_H
+#define MM_PROFILE_H
+
+#include <stdint.h>
+
+/*
+ * Profiler de allocaciones del kernel, apagado por defecto. Encendido, cada mm_alloc/mm_free deja un evento
+ * en un ring buffer fijo y suma los bytes vivos al par (sitio de llamada, PID) que hizo el pedido.
+ */
+#define MM_PROF_RING_SIZE 512
+#define MM_PROF_MAX_SITES 128
+#define MM_PROF_MAX_LIVE 4096 // bloques vivos rastreados a la vez (potencia de 2)
+
+// Comandos de syscall_mem_profile
+#define MM_PROF_CMD_STATUS 0
+#define MM_PROF_CMD_SITES 1
+#define MM_PROF_CMD_EVENTS 2
+#define MM_PROF_CMD_ENABLE 3
+#define MM_PROF_CMD_DISABLE 4
+
+typedef struct {
+	uint64_t caller; // direccion de retorno de la llamada a mm_*
+	uint64_t pid;
+	uint64_t live_bytes;
+	uint64_t live_blocks;
+	uint64_t peak_bytes;
+	uint64_t allocations;
+	uint64_t frees;
+} mm_prof_site_t;
+
+typedef struct {
+	uint64_t caller;
+	uint64_t ptr; // 0 si el pedido fallo
+	uint64_t size;
+	uint64_t pid;
+	uint64_t ticks;
+	uint64_t is_free;
+} mm_prof_event_t;
+
+typedef struct {
+	uint64_t enabled;
+	uint64_t events;		// eventos registrados desde que se encendio (el ring guarda los ultimos)
+	uint64_t sites;
+	uint64_t untracked;		// bloques que no entraron en la tabla de sitios o de bloques vivos
+} mm_prof_status_t;
+
+// Encender reinicia todos los contadores: los bloques pedidos antes no se atribuyen
+void mm_profile_enable(void);
+void mm_profile_disable(void);
+void mm_profile_record_alloc(void *caller, void *ptr, uint64_t size);
+void mm_profile_record_free(void *caller, void *ptr);
+
+void mm_profile_status(mm_prof_status_t *status);
+// Los max_count sitios con mas bytes vivos, de mayor a menor
+uint64_t mm_profile_top_sites(mm_prof_site_t *buffer, uint64_t max_count);
+// Los ultimos max_count eventos, del mas nuevo al mas viejo
+uint64_t mm_profile_recent_events(mm_prof_event_t *buffer, uint64_t max_count);
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef MODULELOADER_H
 #define MODULELOADER_H
 
-void loadModules(void *payloadStart, void **moduleTargetAddress);
+#include <stdint.h>
+
+// Copia los modulos a sus direcciones destino y devuelve la direccion donde termina el ultimo
+uint64_t loadModules(void *payloadStart, void **moduleTargetAddress);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <process.h>
+#include <stdint.h>
+
+/*
+ * Tablas de paginas propias del kernel. Toda la memoria fisica se mapea identidad con paginas de 2 MB globales
+ * (PML4[0]), compartidas por todos los espacios de direcciones. Cada proceso tiene ademas su propia PML4 con una
+ * ventana privada (PML4[1]) donde se ven sus regiones de usuario: la direccion de usuario de un bloque fisico es
+ * PAGING_USER_BASE + fisica, asi el kernel traduce en los dos sentidos sin tablas auxiliares.
+ * Todo corre en ring 0 con la identidad mapeada, asi que la ventana solo evita usar direcciones de otro proceso:
+ * la memoria fisica de cualquier region sigue accesible por su alias identidad.
+ */
+#define PAGING_PAGE_SIZE 0x1000ULL
+#define PAGING_LARGE_PAGE_SIZE 0x200000ULL
+#define PAGING_USER_BASE 0x0000008000000000ULL
+#define PAGING_USER_SIZE 0x0000008000000000ULL
+#define PAGING_MIN_IDENTITY (4ULL << 30) // cubre el framebuffer y el resto del MMIO de 32 bits
+
+/*
+ * Stacks de kernel de los procesos: un rango virtual (PML4[2]) compartido por todos los espacios, con un slot
+ * por stack. El stack ocupa el tope del slot y el resto queda sin mapear como guarda. Solo la pagina del tope
+ * se compromete al crearlo; las demas las mapea el page fault la primera vez que se tocan.
+ */
+#define PAGING_STACK_BASE 0x0000010000000000ULL
+#define PAGING_STACK_SLOT_SIZE 0x10000ULL
+#define PAGING_MAX_STACKS 4096
+#define PAGING_STACK_RESERVE 32 // paginas en cero para los fallos que no pueden llamar al allocator
+
+/*
+ * Pagina local: cada proceso tiene la suya en la misma direccion, el final de su ventana (ninguna region llega
+ * ahi mientras la memoria fisica sea menor a PAGING_USER_SIZE), con un marco propio. Userland guarda ahi lo que
+ * no puede ir en las globales del modulo, que comparten todos los procesos.
+ */
+#define PAGING_LOCAL_PAGE (PAGING_USER_BASE + PAGING_USER_SIZE - PAGING_PAGE_SIZE)
+
+// Comandos de syscall_paging_ctl
+#define PAGING_CMD_STATUS 0
+#define PAGING_CMD_PCID_ON 1
+#define PAGING_CMD_PCID_OFF 2
+
+typedef struct {
+	uint64_t enabled;			// el kernel cargo sus propias tablas en CR3
+	uint64_t pcid_supported;
+	uint64_t pcid_enabled;
+	uint64_t identity_bytes;	// memoria fisica mapeada identidad
+	uint64_t address_spaces;	// PML4 de procesos vivas
+	uint64_t user_pages;		// paginas de 4 KB mapeadas en ventanas de usuario
+	uint64_t table_pages;		// paginas usadas por tablas (incluye las del kernel)
+	uint64_t switches;			// cargas de CR3 hechas por el scheduler
+	uint64_t flushes;			// de esas, cuantas vaciaron la TLB no global
+	uint64_t stacks;			// stacks de kernel con slot propio
+	uint64_t stack_pages;		// paginas comprometidas en esos stacks
+	uint64_t stack_faults;		// paginas de stack mapeadas por el page fault
+} paging_stats_t;
+
+void paging_init(void);
+uint8_t paging_is_enabled(void);
+
+// Mapea [phys, phys + size) en la ventana de p (alineado a pagina); devuelve la direccion de usuario o NULL
+void *paging_map_user(process_t *p, void *phys, uint64_t size);
+void paging_unmap_user(process_t *p, void *user_addr, uint64_t size);
+// Mapea el marco phys como pagina local de p; devuelve PAGING_LOCAL_PAGE (phys sin paginacion) o NULL
+void *paging_map_local(process_t *p, void *phys);
+void *paging_user_to_phys(void *user_addr);
+void *paging_phys_to_user(void *phys);
+// Libera las tablas de p; no puede ser el espacio cargado en CR3
+void paging_destroy(process_t *p);
+
+// Reserva un stack de size bytes; devuelve su base (el tope es base + size) o NULL si no hay slot
+void *paging_stack_alloc(uint64_t size);
+// Devuelve 0 si base no es un stack de paging_stack_alloc (por ejemplo, uno de mm_alloc)
+int paging_stack_free(void *base);
+uint64_t paging_stack_resident(void *base);
+// Compromete la pagina de stack de addr; can_alloc indica que el contexto que fallo no estaba dentro del allocator
+int paging_stack_fault(uint64_t addr, int can_alloc);
+// Repone las paginas de reserva; solo desde contextos que pueden llamar al allocator
+void paging_stack_refill(void);
+
+// Carga el espacio de direcciones de next (o el del kernel si no tiene); lo llama el scheduler
+void paging_switch(process_t *next);
+int paging_set_pcid(int enabled);
+void paging_get_stats(paging_stats_t *stats);
+
+// libasm.asm
+uint64_t read_cr2(void);
+uint64_t read_cr3(void);
+void write_cr3(uint64_t value);
+uint64_t read_cr4(void);
+void write_cr4(uint64_t value);
+void flush_tlb_page(void *addr);
+uint32_t cpuid_ecx(uint32_t leaf);
+uint64_t read_tsc(void);
+
+#endif
@@ -1,11 +1,21 @@
 #ifndef PIPE_H
 #define PIPE_H
 
+#include <poll.h>
 #include <stddef.h>
 #include <stdint.h>
 
-typedef struct pipe_t pipe_t;
+// Capacidad del buffer de un pipe; pipe_set_size redondea a paginas dentro de [PIPE_MIN_SIZE, PIPE_MAX_SIZE]
+#define PIPE_DEFAULT_SIZE 4096
+#define PIPE_MIN_SIZE 4096
+#define PIPE_MAX_SIZE (1024 * 1024)
+// Regalos (pipe_gift) encolados a la vez en un pipe; mas alla el escritor espera
+#define PIPE_MAX_GIFTS 16
+// Los ids de pipe (indice de slot y generacion) entran en 31 bits: create_process recibe dos empaquetados
+#define PIPE_ID_BITS 31
+#define PIPE_ID_MASK ((1ULL << PIPE_ID_BITS) - 1)
 
+typedef struct pipe_t pipe_t;
 
 void pipe_system_init(void);
 uint64_t pipe_create(void);
@@ -14,7 +24,16 @@ int pipe_close_by_id(uint64_t id, int is_writer);
 pipe_t *pipe_get_by_id(uint64_t id);
 uint64_t pipe_get_id(pipe_t *p);
 
-int pipe_read(pipe_t *p, char *buffer, size_t count);
-int pipe_write(pipe_t *p, const char *buffer, size_t count);
+// Resultado de pipe_read/pipe_write con nonblock cuando tendrian que esperar
+#define PIPE_WOULD_BLOCK (-1)
+
+int pipe_read(pipe_t *p, char *buffer, size_t count, int nonblock);
+int pipe_write(pipe_t *p, const char *buffer, size_t count, int nonblock);
+uint64_t pipe_set_size(uint64_t id, uint64_t size);
+int pipe_gift(pipe_t *p, void *base, size_t size);
+int pipe_splice(pipe_t *in, pipe_t *out, size_t count);
+// Eventos de poll listos en la punta de lectura o de escritura y la cola donde esperar a que cambien
+int pipe_poll(pipe_t *p, int is_writer);
+wait_queue_t *pipe_wait_queue(pipe_t *p, int is_writer);
 
 #endif
@@ -0,0 +1,49 @@
+#ifndef POLL_H
+#define POLL_H
+
+#include <stdint.h>
+
+// Eventos de poll (los mismos valores que POSIX)
+#define POLL_IN 0x01   // hay datos para leer (o teclas en el buffer)
+#define POLL_OUT 0x04  // hay lugar para escribir
+#define POLL_HUP 0x10  // la otra punta del pipe se cerro
+#define POLL_NVAL 0x20 // el fd no es un pipe ni la terminal
+
+typedef struct {
+	int32_t fd; // los fd negativos se ignoran
+	int16_t events;
+	int16_t revents;
+} poll_fd_t;
+
+typedef struct poll_waiter poll_waiter_t;
+
+/*
+ * Cola de procesos bloqueados en poll esperando un cambio en un pipe o en el teclado. Las entradas viven en
+ * el PCB del proceso que espera: wait_queue_wake_all solo lo despierta y el proceso se saca de las colas al
+ * volver (o al morir, en process_close_fds).
+ */
+typedef struct {
+	poll_waiter_t *head;
+} wait_queue_t;
+
+struct poll_waiter {
+	struct process_control_block *process;
+	wait_queue_t *queue;
+	poll_waiter_t *next;
+	poll_waiter_t *prev;
+};
+
+void wait_queue_wake_all(wait_queue_t *q);
+
+/*
+ * Espera a que alguno de los fds del proceso actual tenga listo alguno de sus eventos y completa revents.
+ * timeout_ms 0 no bloquea y uno negativo espera sin limite. Devuelve cuantos fds tienen eventos (0 si vencio
+ * el tiempo) o -1 si los argumentos no son validos.
+ */
+int64_t poll_wait(poll_fd_t *fds, uint64_t count, int64_t timeout_ms);
+// Saca a p de todas las colas en las que espera; lo llama process_close_fds
+void poll_cancel(struct process_control_block *p);
+// Despierta a los poll bloqueados cuyo tiempo vencio; lo llama el scheduler en cada tick
+void poll_expire(uint64_t now);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <poll.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -13,17 +14,28 @@
 #define PROCESS_PRIORITY_DEFAULT 1
 
 #define MAX_FDS 16 // Número máximo de file descriptors por proceso
+#define MAX_SHM_ATTACH 8 // Segmentos de memoria compartida adjuntos a la vez por proceso
 
 typedef struct process_control_block process_t;
 typedef void (*process_entry_point_t)(void *);
 
 typedef struct pipe_t pipe_t;
+typedef struct process_mem_block process_mem_block_t;
+typedef struct shm_segment shm_segment_t;
+typedef struct address_space address_space_t;
 
 typedef enum { FD_TYPE_TERMINAL = 0, FD_TYPE_PIPE_READ = 1, FD_TYPE_PIPE_WRITE = 2 } fd_type_t;
 
+// Flags por fd (fd_entry_t.flags); se cambian con syscall_fcntl
+#define O_NONBLOCK 0x800 // read/write devuelven FD_WOULD_BLOCK en lugar de bloquear
+#define FD_WOULD_BLOCK ((uint64_t) -1)
+#define F_GETFL 3
+#define F_SETFL 4
+
 typedef struct {
 	fd_type_t type;
 	pipe_t *pipe;
+	uint32_t flags;
 } fd_entry_t;
 
 typedef enum {
@@ -55,6 +67,7 @@ struct process_control_block {
 	void *entry_arg;
 	uint64_t waiting_on_pid;
 	int is_foreground;
+	uint64_t foreground_owed_by; // hijo que termino en foreground mientras se esperaba a otro
 	process_t *parent;
 	process_t *first_child;
 	process_t *next_sibling;
@@ -69,8 +82,27 @@ struct process_control_block {
 
 	process_t *sem_waiter_next;
 
+	// Marco de la pagina local del proceso (PAGING_LOCAL_PAGE); NULL hasta que userland la pide
+	void *local_page;
+
+	// Memoria de usuario a nombre del proceso; se devuelve entera en process_destroy
+	process_mem_block_t *mem_blocks;
+	uint64_t mem_bytes;
+	uint64_t mem_block_count;
+	uint64_t mem_quota; // 0 = sin limite
 
 	fd_entry_t fds[MAX_FDS];
+
+	// Entradas en colas de espera mientras el proceso esta bloqueado en poll (una por fd consultado)
+	poll_waiter_t poll_waiters[MAX_FDS];
+	int poll_waiter_count;
+	uint64_t poll_deadline; // tick en que vence el poll (0 = sin limite)
+	process_t *poll_timed_next;
+
+	shm_segment_t *shm_attached[MAX_SHM_ATTACH];
+
+	// Tablas de paginas propias; NULL hasta que el proceso pide su primera region de usuario
+	address_space_t *aspace;
 };
 
 void process_system_init(void);
@@ -82,6 +114,19 @@ void process_destroy(process_t *p);
 
 void process_close_fds(process_t *p);
 
+// Reemplaza el argumento de entrada de un proceso que todavia no corrio
+void process_set_entry_arg(process_t *p, void *entry_arg);
+
+void process_memory_init(void);
+void *process_mem_alloc(process_t *p, uint64_t size);
+void *process_mem_alloc_aligned(process_t *p, uint64_t size, uint64_t align);
+int process_mem_free(process_t *p, void *ptr);
+void process_mem_release_all(process_t *p);
+void *process_mem_lookup(process_t *p, void *ptr, uint64_t *size);
+int process_mem_detach(process_t *p, void *ptr);
+void *process_mem_local(process_t *p);
+char **process_copy_argv(process_t *p, char *const argv[]);
+
 void process_attach_child(process_t *parent, process_t *child);
 void process_detach_child(process_t *child);
 
@@ -106,6 +151,8 @@ typedef struct {
 	uint64_t rsp;
 	uint64_t rbp;
 	int foreground;
+	uint64_t mem_bytes;
+	uint64_t stack_bytes; // paginas de stack comprometidas
 } process_info_t;
 
 #endif
@@ -31,4 +31,7 @@ uint64_t scheduler_list_all_processes(process_info_t *buffer, uint64_t max_count
 // Función para obtener el PID del proceso en foreground (o 0 si no hay)
 uint64_t scheduler_get_foreground_pid(void);
 
+// Fija el máximo de memoria de usuario del proceso (0 = sin límite)
+int scheduler_set_mem_quota(uint64_t pid, uint64_t quota);
+
 #endif
@@ -0,0 +1,24 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <process.h>
+#include <stdint.h>
+
+#define MAX_SHM_SEGMENTS 32
+#define SHM_NAME_MAX_LEN 23
+#define SHM_MAX_SIZE (16ULL * 1024 * 1024)
+
+/*
+ * Segmentos de memoria compartida con nombre. Adjuntar mapea el segmento en la ventana de usuario del proceso
+ * y suma una referencia; como la ventana traduce fisica + PAGING_USER_BASE, todos lo ven en la misma direccion.
+ * Desadjuntar lo saca de la ventana y el segmento se libera cuando se desadjunta el ultimo proceso
+ * (explicitamente o al terminar).
+ */
+// Crea el segmento y lo adjunta a p; NULL si el nombre ya existe o no hay memoria
+void *shm_create(process_t *p, const char *name, uint64_t size);
+// Adjunta p a un segmento existente; en size_out deja su tamaño. Adjuntar dos veces devuelve la misma direccion
+void *shm_attach(process_t *p, const char *name, uint64_t *size_out);
+int shm_detach(process_t *p, void *addr);
+void shm_detach_all(process_t *p);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SLAB_NAME_MAX_LEN 23
+#define MAX_SLAB_CACHES 16
+
+typedef struct slab_cache slab_cache_t;
+
+// El constructor se llama una vez por objeto al crear el slab; los objetos deben liberarse en ese estado
+typedef void (*slab_ctor_t)(void *obj);
+
+typedef struct {
+	char name[SLAB_NAME_MAX_LEN + 1];
+	uint64_t object_size;
+	uint64_t objects_per_slab;
+	uint64_t slab_bytes;
+	uint64_t slabs_full;
+	uint64_t slabs_partial;
+	uint64_t slabs_empty;
+	uint64_t active_objects;
+	uint64_t total_objects;
+	uint64_t allocations;
+	uint64_t frees;
+} slab_info_t;
+
+slab_cache_t *slab_cache_create(const char *name, uint64_t object_size, slab_ctor_t ctor);
+void *slab_alloc(slab_cache_t *cache);
+void slab_free(slab_cache_t *cache, void *obj);
+void slab_cache_reap(slab_cache_t *cache);
+
+uint64_t slab_get_info(slab_info_t *buffer, uint64_t max_count);
+
+#endif
@@ -46,5 +46,25 @@ uint64_t syscall_pipe_dup(uint64_t pipe_id, uint64_t fd, uint64_t mode, uint64_t
 uint64_t syscall_pipe_release_fd(uint64_t fd, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4);
 uint64_t syscall_get_foreground_pid(uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4,
 									uint64_t unused5);
+uint64_t syscall_slab_info(uint64_t user_addr, uint64_t max_count, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_region_alloc(uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_region_free(uint64_t address, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_set_mem_quota(uint64_t pid, uint64_t quota, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_region_alloc_aligned(uint64_t size, uint64_t align, uint64_t unused2, uint64_t unused3,
+									  uint64_t unused4);
+uint64_t syscall_mem_profile(uint64_t cmd, uint64_t user_addr, uint64_t max_count, uint64_t unused1, uint64_t unused2);
+uint64_t syscall_shm_create(uint64_t name, uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3);
+uint64_t syscall_shm_attach(uint64_t name, uint64_t size_out, uint64_t unused1, uint64_t unused2, uint64_t unused3);
+uint64_t syscall_shm_detach(uint64_t address, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_heap_info(uint64_t user_addr, uint64_t max_count, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_set_heap_use(uint64_t use, uint64_t heap, uint64_t unused2, uint64_t unused3, uint64_t unused4);
+uint64_t syscall_paging_ctl(uint64_t cmd, uint64_t user_addr, uint64_t unused1, uint64_t unused2, uint64_t unused3);
+uint64_t syscall_pipe_set_size(uint64_t pipe_id, uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3);
+uint64_t syscall_pipe_splice(uint64_t fd_in, uint64_t fd_out, uint64_t count, uint64_t unused1, uint64_t unused2);
+uint64_t syscall_pipe_gift(uint64_t fd, uint64_t address, uint64_t length, uint64_t unused1, uint64_t unused2);
+uint64_t syscall_poll(uint64_t fds, uint64_t count, uint64_t timeout_ms, uint64_t unused1, uint64_t unused2);
+uint64_t syscall_fcntl(uint64_t fd, uint64_t cmd, uint64_t flags, uint64_t unused1, uint64_t unused2);
+uint64_t syscall_user_heap_slot(uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4,
+								uint64_t unused5);
 
 #endif
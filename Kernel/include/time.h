@@ -1,6 +1,9 @@
 #ifndef _TIME_H_
 #define _TIME_H_
 
+// Interrupciones del timer por segundo: el PIT queda con el divisor por defecto (~18.2 Hz)
+#define TIMER_HZ 18
+
 void timer_handler();
 int ticks_elapsed();
 int seconds_elapsed();
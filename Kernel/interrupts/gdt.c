@@ -0,0 +1,57 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <defs.h>
+#include <gdt.h>
+#include <stdint.h>
+
+#pragma pack(push)
+#pragma pack(1)
+
+/* Task State Segment de 64 bits: solo se usa por la tabla de IST */
+typedef struct {
+	uint32_t reserved0;
+	uint64_t rsp[3];
+	uint64_t reserved1;
+	uint64_t ist[7];
+	uint64_t reserved2;
+	uint16_t reserved3;
+	uint16_t iomap_base;
+} TSS;
+
+typedef struct {
+	uint16_t limit;
+	uint64_t base;
+} GDTR;
+
+#pragma pack(pop)
+
+#define GDT_ENTRIES 5 // null, codigo, datos y el descriptor de TSS (ocupa dos)
+
+static uint64_t gdt[GDT_ENTRIES] __attribute__((aligned(16)));
+static TSS tss __attribute__((aligned(16)));
+static uint8_t ist_fault_stack[GDT_IST_STACK_SIZE] __attribute__((aligned(16)));
+static uint8_t ist_irq_stack[GDT_IST_STACK_SIZE] __attribute__((aligned(16)));
+
+/*
+ * Reemplaza la GDT de Pure64 por una propia que agrega un TSS. Los descriptores de codigo y datos son los mismos,
+ * asi que los selectores cargados siguen siendo validos.
+ */
+void load_gdt_tss(void) {
+	uint64_t base = (uint64_t) &tss;
+	uint64_t limit = sizeof(TSS) - 1;
+
+	gdt[0] = 0;
+	gdt[GDT_CODE_SEL / 8] = 0x0020980000000000ULL;
+	gdt[GDT_DATA_SEL / 8] = 0x0000900000000000ULL;
+	gdt[GDT_TSS_SEL / 8] = (limit & 0xFFFF) | ((base & 0xFFFFFF) << 16) | ((uint64_t) ACS_TSS << 40) |
+						   (((limit >> 16) & 0xF) << 48) | (((base >> 24) & 0xFF) << 56);
+	gdt[GDT_TSS_SEL / 8 + 1] = base >> 32;
+
+	tss.ist[GDT_IST_PAGE_FAULT - 1] = (uint64_t) (ist_fault_stack + GDT_IST_STACK_SIZE);
+	tss.ist[GDT_IST_IRQ - 1] = (uint64_t) (ist_irq_stack + GDT_IST_STACK_SIZE);
+	tss.iomap_base = sizeof(TSS);
+
+	GDTR gdtr = {sizeof(gdt) - 1, (uint64_t) gdt};
+	load_gdt(&gdtr);
+	load_tr(GDT_TSS_SEL);
+}
@@ -1,6 +1,7 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <defs.h>
+#include <gdt.h>
 #include <idtLoader.h>
 #include <interrupts.h>
 #include <stdint.h>
@@ -21,12 +22,14 @@ typedef struct {
 DESCR_INT *idt = (DESCR_INT *) 0;
 
 static void setup_IDT_entry(int index, uint64_t offset);
+static void setup_IDT_entry_ist(int index, uint64_t offset, uint8_t ist);
 
 void load_idt() {
-	setup_IDT_entry(0x20, (uint64_t) &_irq00Handler);
+	setup_IDT_entry_ist(0x20, (uint64_t) &_irq00Handler, GDT_IST_IRQ);
 	setup_IDT_entry(0x00, (uint64_t) &_exception0Handler);
 	setup_IDT_entry(0x06, (uint64_t) &_exception6Handler);
-	setup_IDT_entry(0x21, (uint64_t) &_irq01Handler);
+	setup_IDT_entry_ist(0x0E, (uint64_t) &_exception14Handler, GDT_IST_PAGE_FAULT);
+	setup_IDT_entry_ist(0x21, (uint64_t) &_irq01Handler, GDT_IST_IRQ);
 	setup_IDT_entry(0x80, (uint64_t) &_irq80Handler);
 
 	picMasterMask(0xFC);
@@ -34,11 +37,16 @@ void load_idt() {
 }
 
 static void setup_IDT_entry(int index, uint64_t offset) {
+	setup_IDT_entry_ist(index, offset, 0);
+}
+
+// ist distinto de 0 hace que el CPU cambie al stack alternativo de ese indice del TSS
+static void setup_IDT_entry_ist(int index, uint64_t offset, uint8_t ist) {
 	idt[index].selector = 0x08;
 	idt[index].offset_l = offset & 0xFFFF;
 	idt[index].offset_m = (offset >> 16) & 0xFFFF;
 	idt[index].offset_h = (offset >> 32) & 0xFFFFFFFF;
 	idt[index].access = ACS_INT;
-	idt[index].cero = 0;
+	idt[index].cero = ist;
 	idt[index].other_cero = (uint64_t) 0;
 }
@@ -1,54 +1,153 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <lib.h>
+#include <mm.h>
 #include <pipe.h>
+#include <poll.h>
 #include <process.h>
 #include <semaphore.h>
+#include <slab.h>
 #include <stddef.h>
 #include <string.h>
 
-#define MAX_PIPES 64
-#define PIPE_BUFFER_SIZE 4096
+typedef struct pipe_gift pipe_gift_t;
+
+// Bloque del heap del kernel que un escritor le regalo al pipe (pipe_gift): se lee de ahi sin copiarlo antes
+struct pipe_gift {
+	char *base;
+	size_t size;		// bytes con datos
+	size_t offset;		// bytes ya leidos
+	uint64_t ring_mark; // ring_in al encolarlo: va despues de los bytes del buffer escritos antes
+	pipe_gift_t *next;
+};
 
 struct pipe_t {
 	uint64_t id;
-	char buffer[PIPE_BUFFER_SIZE];
+	char *buffer;
+	size_t capacity; // bytes del buffer circular (multiplo de MM_PAGE_SIZE)
 	size_t read_pos;
 	size_t write_pos;
-	size_t count;
+	size_t count;	  // bytes sin leer en el buffer circular
+	uint64_t ring_in;  // bytes escritos en el buffer desde que se creo el pipe
+	uint64_t ring_out; // bytes leidos del buffer desde que se creo el pipe
+	pipe_gift_t *gift_head;
+	pipe_gift_t *gift_tail;
+	int gift_count;
+	size_t gift_bytes; // bytes sin leer en los regalos
 	int readers;		 // Contador de lectores
 	int writers;		 // Contador de escritores
-	uint64_t sem_items;	 // Semáforo para items disponibles (inicialmente = 0)
-	uint64_t sem_spaces; // Semáforo para espacios disponibles (inicialmente = PIPE_BUFFER_SIZE)
+	int readers_waiting; // Lectores bloqueados esperando datos
+	int writers_waiting; // Escritores bloqueados esperando espacio
+	uint64_t sem_items;	 // Despierta lectores (inicialmente = 0, se señala una vez por lector en espera)
+	uint64_t sem_spaces; // Despierta escritores (inicialmente = 0, se señala una vez por escritor en espera)
 	uint64_t mutex;		 // Mutex para exclusión mutua
-	int used;
+	wait_queue_t read_queue;  // poll esperando la punta de lectura
+	wait_queue_t write_queue; // poll esperando la punta de escritura
 };
 
-static pipe_t pipes[MAX_PIPES];
-static uint64_t next_pipe_id = 1;
+/*
+ * Los datos se copian por tramos contiguos con memcpy (a lo sumo dos por operacion, si el tramo da la vuelta
+ * al buffer) con el mutex tomado una sola vez. sem_items y sem_spaces ya no cuentan bytes: solo despiertan
+ * a los procesos que se anotaron en readers_waiting/writers_waiting, asi que una operacion sin nadie
+ * esperando no toca esos semaforos. El que despierta vuelve a mirar el estado del pipe con el mutex tomado.
+ */
+
+/*
+ * Los pipes y sus buffers se piden al heap del kernel al crearlos. Cada pipe ocupa un slot de pipe_table,
+ * que se duplica cuando se llena (hasta PIPE_ID_INDEX_MASK slots). El id lleva el indice del slot mas uno
+ * y la generacion del slot, que avanza cada vez que se libera: buscar un pipe es un acceso al arreglo y
+ * un id viejo no encuentra al pipe que reuso su slot. Las syscalls corren con las interrupciones
+ * deshabilitadas y nadie bloquea a mitad de una busqueda, asi que la tabla no necesita lock propio.
+ */
+#define PIPE_ID_INDEX_BITS 16
+#define PIPE_ID_INDEX_MASK ((1ULL << PIPE_ID_INDEX_BITS) - 1)
+#define PIPE_ID_GEN_MASK ((1ULL << (PIPE_ID_BITS - PIPE_ID_INDEX_BITS)) - 1)
+#define PIPE_TABLE_INITIAL 64
+
+typedef struct {
+	pipe_t *pipe;
+	uint32_t generation;
+	int32_t next_free; // siguiente slot libre o -1
+} pipe_slot_t;
+
+static slab_cache_t *pipe_cache = NULL;
+static slab_cache_t *gift_cache = NULL;
+static pipe_slot_t *pipe_table = NULL;
+static int32_t pipe_table_size = 0;
+static int32_t pipe_free_head = -1;
 
 void pipe_system_init(void) {
-	for (int i = 0; i < MAX_PIPES; i++) {
-		pipes[i].used = 0;
-		pipes[i].id = 0;
-		pipes[i].read_pos = 0;
-		pipes[i].write_pos = 0;
-		pipes[i].count = 0;
-		pipes[i].readers = 0;
-		pipes[i].writers = 0;
-		pipes[i].sem_items = 0;
-		pipes[i].sem_spaces = 0;
-		pipes[i].mutex = 0;
-	}
-	next_pipe_id = 1;
+	if (!pipe_cache)
+		pipe_cache = slab_cache_create("pipe_t", sizeof(pipe_t), NULL);
+	if (!gift_cache)
+		gift_cache = slab_cache_create("pipe_gift", sizeof(pipe_gift_t), NULL);
 }
 
 static pipe_t *find_pipe_by_id(uint64_t id) {
-	for (int i = 0; i < MAX_PIPES; ++i) {
-		if (pipes[i].used && pipes[i].id == id) {
-			return &pipes[i];
-		}
+	uint64_t index = (id & PIPE_ID_INDEX_MASK) - 1;
+	if (index >= (uint64_t) pipe_table_size)
+		return NULL;
+	pipe_slot_t *slot = &pipe_table[index];
+	if (!slot->pipe || slot->generation != (id >> PIPE_ID_INDEX_BITS))
+		return NULL;
+	return slot->pipe;
+}
+
+static int grow_pipe_table(void) {
+	int32_t new_size = pipe_table_size ? pipe_table_size * 2 : PIPE_TABLE_INITIAL;
+	if ((uint64_t) new_size > PIPE_ID_INDEX_MASK)
+		new_size = PIPE_ID_INDEX_MASK;
+	if (new_size <= pipe_table_size)
+		return 0;
+
+	pipe_slot_t *table = (pipe_slot_t *) mm_alloc(new_size * sizeof(pipe_slot_t));
+	if (!table)
+		return 0;
+	if (pipe_table) {
+		memcpy(table, pipe_table, pipe_table_size * sizeof(pipe_slot_t));
+		mm_free(pipe_table);
+	}
+	// Los slots nuevos quedan libres, encadenados en orden
+	for (int32_t i = pipe_table_size; i < new_size; i++) {
+		table[i].pipe = NULL;
+		table[i].generation = 1;
+		table[i].next_free = (i + 1 < new_size) ? i + 1 : pipe_free_head;
 	}
-	return NULL;
+	pipe_free_head = pipe_table_size;
+	pipe_table = table;
+	pipe_table_size = new_size;
+	return 1;
+}
+
+// Le da un slot a p y le arma el id; 0 si la tabla no puede crecer
+static uint64_t register_pipe(pipe_t *p) {
+	if (pipe_free_head < 0 && !grow_pipe_table())
+		return 0;
+	int32_t index = pipe_free_head;
+	pipe_slot_t *slot = &pipe_table[index];
+	pipe_free_head = slot->next_free;
+	slot->pipe = p;
+	return ((uint64_t) slot->generation << PIPE_ID_INDEX_BITS) | (uint64_t) (index + 1);
+}
+
+static void unregister_pipe(pipe_t *p) {
+	int32_t index = (int32_t) ((p->id & PIPE_ID_INDEX_MASK) - 1);
+	pipe_slot_t *slot = &pipe_table[index];
+	slot->pipe = NULL;
+	slot->generation = (slot->generation + 1) & PIPE_ID_GEN_MASK;
+	if (slot->generation == 0)
+		slot->generation = 1;
+	slot->next_free = pipe_free_head;
+	pipe_free_head = index;
+}
+
+// Redondea a paginas; 0 si size queda fuera de [PIPE_MIN_SIZE, PIPE_MAX_SIZE]
+static size_t pipe_round_size(uint64_t size) {
+	if (size > PIPE_MAX_SIZE)
+		return 0;
+	if (size < PIPE_MIN_SIZE)
+		size = PIPE_MIN_SIZE;
+	return (size + MM_PAGE_SIZE - 1) & ~(MM_PAGE_SIZE - 1);
 }
 
 pipe_t *pipe_get_by_id(uint64_t id) {
@@ -64,42 +163,173 @@ uint64_t pipe_get_id(pipe_t *p) {
 }
 
 uint64_t pipe_create(void) {
-	for (int i = 0; i < MAX_PIPES; ++i) {
-		if (!pipes[i].used) {
-			pipe_t *p = &pipes[i];
+	if (!pipe_cache || !gift_cache)
+		return 0;
 
-			memset(p, 0, sizeof(pipe_t));
+	pipe_t *p = (pipe_t *) slab_alloc(pipe_cache);
+	if (!p) {
+		return 0;
+	}
+	memset(p, 0, sizeof(pipe_t));
 
-			p->sem_items = sem_alloc(0);
-			if (p->sem_items == 0) {
-				return 0;
-			}
+	p->capacity = PIPE_DEFAULT_SIZE;
+	p->buffer = (char *) mm_alloc(p->capacity);
+	if (!p->buffer) {
+		slab_free(pipe_cache, p);
+		return 0;
+	}
 
-			p->sem_spaces = sem_alloc(PIPE_BUFFER_SIZE);
-			if (p->sem_spaces == 0) {
-				sem_close_by_id(p->sem_items);
-				return 0;
-			}
+	p->sem_items = sem_alloc(0);
+	p->sem_spaces = p->sem_items ? sem_alloc(0) : 0;
+	p->mutex = p->sem_spaces ? sem_alloc(1) : 0;
+	p->id = p->mutex ? register_pipe(p) : 0;
+	if (p->id == 0) {
+		if (p->sem_items)
+			sem_close_by_id(p->sem_items);
+		if (p->sem_spaces)
+			sem_close_by_id(p->sem_spaces);
+		if (p->mutex)
+			sem_close_by_id(p->mutex);
+		mm_free(p->buffer);
+		slab_free(pipe_cache, p);
+		return 0;
+	}
 
-			p->mutex = sem_alloc(1);
-			if (p->mutex == 0) {
-				sem_close_by_id(p->sem_items);
-				sem_close_by_id(p->sem_spaces);
-				return 0;
-			}
+	return p->id;
+}
+
+// Despierta a todos los que esperan en *waiting; se llama con el mutex tomado
+static void wake_all(uint64_t sem, int *waiting) {
+	while (*waiting > 0) {
+		sem_signal_by_id(sem);
+		(*waiting)--;
+	}
+}
+
+// Despiertan tambien a los poll de cada punta: cualquier cambio puede dejar listo un evento
+static void wake_readers(pipe_t *p) {
+	wake_all(p->sem_items, &p->readers_waiting);
+	wait_queue_wake_all(&p->read_queue);
+}
+
+static void wake_writers(pipe_t *p) {
+	wake_all(p->sem_spaces, &p->writers_waiting);
+	wait_queue_wake_all(&p->write_queue);
+}
+
+// Suelta el mutex, espera en sem y lo vuelve a tomar; devuelve 0 si alguno de los semaforos ya no existe
+static int wait_unlocked(pipe_t *p, uint64_t sem, int *waiting) {
+	(*waiting)++;
+	sem_signal_by_id(p->mutex);
+	if (!sem_wait_by_id(sem))
+		return 0;
+	return sem_wait_by_id(p->mutex);
+}
+
+/*
+ * El contenido del pipe es el buffer circular intercalado con los regalos: cada regalo se lee despues de
+ * los bytes del buffer escritos antes de encolarlo (ring_mark) y antes de los que vinieron despues.
+ */
+static size_t pipe_available(pipe_t *p) {
+	return p->count + p->gift_bytes;
+}
+
+// Bytes del buffer circular que se pueden leer antes del proximo regalo
+static size_t ring_readable(pipe_t *p) {
+	if (p->gift_head)
+		return (size_t) (p->gift_head->ring_mark - p->ring_out);
+	return p->count;
+}
 
-			p->id = next_pipe_id++;
-			p->read_pos = 0;
-			p->write_pos = 0;
-			p->count = 0;
-			p->readers = 0;
-			p->writers = 0;
-			p->used = 1;
+static void ring_consume(pipe_t *p, size_t n) {
+	p->read_pos += n;
+	if (p->read_pos >= p->capacity)
+		p->read_pos -= p->capacity;
+	p->count -= n;
+	p->ring_out += n;
+}
+
+// n no puede superar ring_readable(p)
+static void ring_take(pipe_t *p, char *dst, size_t n) {
+	size_t first = p->capacity - p->read_pos;
+	if (first > n)
+		first = n;
+	memcpy(dst, p->buffer + p->read_pos, first);
+	memcpy(dst + first, p->buffer, n - first);
+	ring_consume(p, n);
+}
 
-			return p->id;
+// n no puede superar el espacio libre del buffer
+static void ring_put(pipe_t *p, const char *src, size_t n) {
+	size_t first = p->capacity - p->write_pos;
+	if (first > n)
+		first = n;
+	memcpy(p->buffer + p->write_pos, src, first);
+	memcpy(p->buffer, src + first, n - first);
+	p->write_pos += n;
+	if (p->write_pos >= p->capacity)
+		p->write_pos -= p->capacity;
+	p->count += n;
+	p->ring_in += n;
+}
+
+static void gift_push(pipe_t *p, pipe_gift_t *g) {
+	g->ring_mark = p->ring_in;
+	g->next = NULL;
+	if (p->gift_tail)
+		p->gift_tail->next = g;
+	else
+		p->gift_head = g;
+	p->gift_tail = g;
+	p->gift_count++;
+	p->gift_bytes += g->size - g->offset;
+}
+
+static pipe_gift_t *gift_pop(pipe_t *p) {
+	pipe_gift_t *g = p->gift_head;
+	p->gift_head = g->next;
+	if (!p->gift_head)
+		p->gift_tail = NULL;
+	p->gift_count--;
+	p->gift_bytes -= g->size - g->offset;
+	return g;
+}
+
+static void gift_release(pipe_gift_t *g) {
+	mm_free(g->base);
+	slab_free(gift_cache, g);
+}
+
+// Avanza n bytes en el primer regalo; si se termino de leer se libera
+static void gift_consume(pipe_t *p, size_t n) {
+	pipe_gift_t *g = p->gift_head;
+	g->offset += n;
+	p->gift_bytes -= n;
+	if (g->offset == g->size)
+		gift_release(gift_pop(p));
+}
+
+// Lee hasta count bytes de lo disponible, respetando el orden entre buffer y regalos
+static size_t read_locked(pipe_t *p, char *dst, size_t count) {
+	size_t done = 0;
+	while (done < count && pipe_available(p) > 0) {
+		size_t n = ring_readable(p);
+		if (n > 0) {
+			if (n > count - done)
+				n = count - done;
+			ring_take(p, dst + done, n);
+		}
+		else {
+			pipe_gift_t *g = p->gift_head;
+			n = g->size - g->offset;
+			if (n > count - done)
+				n = count - done;
+			memcpy(dst + done, g->base + g->offset, n);
+			gift_consume(p, n);
 		}
+		done += n;
 	}
-	return 0;
+	return done;
 }
 
 int pipe_open_by_id(uint64_t id, int is_writer) {
@@ -127,6 +357,7 @@ int pipe_close_by_id(uint64_t id, int is_writer) {
 	sem_wait_by_id(p->mutex);
 
 	int was_last_writer = 0;
+	int was_last_reader = 0;
 
 	if (is_writer) {
 		if (p->writers > 0) {
@@ -137,6 +368,7 @@ int pipe_close_by_id(uint64_t id, int is_writer) {
 	else {
 		if (p->readers > 0) {
 			p->readers--;
+			was_last_reader = (p->readers == 0);
 		}
 	}
 
@@ -147,30 +379,23 @@ int pipe_close_by_id(uint64_t id, int is_writer) {
 		uint64_t spaces_id = p->sem_spaces;
 		uint64_t mutex_id = p->mutex;
 
-		p->used = 0;
-		p->id = 0;
-		p->sem_items = 0;
-		p->sem_spaces = 0;
-		p->mutex = 0;
-		p->read_pos = 0;
-		p->write_pos = 0;
-		p->count = 0;
-
+		unregister_pipe(p);
 		sem_signal_by_id(mutex_id);
 
 		sem_close_by_id(items_id);
 		sem_close_by_id(spaces_id);
 		sem_close_by_id(mutex_id);
+		while (p->gift_head)
+			gift_release(gift_pop(p));
+		mm_free(p->buffer);
+		slab_free(pipe_cache, p);
 	}
 	else {
-		if (was_last_writer) {
-			int readers_to_wake = p->readers;
-			if (readers_to_wake > 0) {
-				for (int i = 0; i < readers_to_wake && i < 100; i++) {
-					sem_signal_by_id(p->sem_items);
-				}
-			}
-		}
+		// Los lectores en espera ven EOF y los escritores en espera ven que no queda quien lea
+		if (was_last_writer)
+			wake_readers(p);
+		if (was_last_reader)
+			wake_writers(p);
 
 		sem_signal_by_id(p->mutex);
 	}
@@ -178,83 +403,299 @@ int pipe_close_by_id(uint64_t id, int is_writer) {
 	return 1;
 }
 
-int pipe_read(pipe_t *p, char *buffer, size_t count) {
+/*
+ * Devuelve lo que haya (hasta count) apenas hay datos; 0 si el pipe esta vacio y sin escritores. Con nonblock
+ * no espera: si esta vacio pero quedan escritores devuelve PIPE_WOULD_BLOCK.
+ */
+int pipe_read(pipe_t *p, char *buffer, size_t count, int nonblock) {
 	if (!p || !buffer || count == 0) {
 		return 0;
 	}
 
-	size_t bytes_read = 0;
-
-	while (bytes_read < count) {
-		if (!sem_wait_by_id(p->mutex)) {
-			break;
-		}
+	if (!sem_wait_by_id(p->mutex)) {
+		return 0;
+	}
 
-		if (p->count == 0 && p->writers == 0) {
+	while (pipe_available(p) == 0) {
+		if (p->writers == 0) {
 			sem_signal_by_id(p->mutex);
-			break;
+			return 0;
 		}
-
-		if (p->count > 0) {
-			buffer[bytes_read] = p->buffer[p->read_pos];
-			p->read_pos = (p->read_pos + 1) % PIPE_BUFFER_SIZE;
-			p->count--;
-			bytes_read++;
-
+		if (nonblock) {
 			sem_signal_by_id(p->mutex);
-			sem_signal_by_id(p->sem_spaces);
+			return PIPE_WOULD_BLOCK;
 		}
-		else {
-			if (bytes_read > 0) {
-				sem_signal_by_id(p->mutex);
-				break;
-			}
-
-			sem_signal_by_id(p->mutex);
-
-			if (!sem_wait_by_id(p->sem_items)) {
-				break;
-			}
+		if (!wait_unlocked(p, p->sem_items, &p->readers_waiting)) {
+			return 0;
 		}
 	}
 
-	return (int) bytes_read;
+	size_t n = read_locked(p, buffer, count);
+
+	wake_writers(p);
+	sem_signal_by_id(p->mutex);
+
+	return (int) n;
 }
 
-int pipe_write(pipe_t *p, const char *buffer, size_t count) {
+/*
+ * Escribe todo count salvo que no queden lectores; devuelve los bytes escritos. Con nonblock escribe lo que
+ * entra sin esperar y, si no entra nada, devuelve PIPE_WOULD_BLOCK.
+ */
+int pipe_write(pipe_t *p, const char *buffer, size_t count, int nonblock) {
 	if (!p || !buffer || count == 0) {
 		return 0;
 	}
 
+	if (!sem_wait_by_id(p->mutex)) {
+		return 0;
+	}
+
 	size_t bytes_written = 0;
 
 	while (bytes_written < count) {
-		if (!sem_wait_by_id(p->mutex)) {
+		if (p->readers == 0) {
 			break;
 		}
 
-		if (p->readers == 0) {
-			sem_signal_by_id(p->mutex);
-			break;
+		if (p->count == p->capacity) {
+			if (nonblock) {
+				if (bytes_written == 0) {
+					sem_signal_by_id(p->mutex);
+					return PIPE_WOULD_BLOCK;
+				}
+				break;
+			}
+			if (!wait_unlocked(p, p->sem_spaces, &p->writers_waiting)) {
+				return (int) bytes_written;
+			}
+			continue;
 		}
 
-		if (p->count < PIPE_BUFFER_SIZE) {
-			p->buffer[p->write_pos] = buffer[bytes_written];
-			p->write_pos = (p->write_pos + 1) % PIPE_BUFFER_SIZE;
-			p->count++;
-			bytes_written++;
+		size_t n = count - bytes_written;
+		if (n > p->capacity - p->count)
+			n = p->capacity - p->count;
+		ring_put(p, buffer + bytes_written, n);
+		bytes_written += n;
 
-			sem_signal_by_id(p->mutex);
-			sem_signal_by_id(p->sem_items);
+		wake_readers(p);
+	}
+
+	sem_signal_by_id(p->mutex);
+
+	return (int) bytes_written;
+}
+
+/*
+ * Cambia la capacidad del buffer (como F_SETPIPE_SZ); size 0 solo consulta. Los datos pendientes se copian
+ * al buffer nuevo, que no puede ser mas chico que lo que hay sin leer. Devuelve la capacidad o 0 si falla.
+ */
+uint64_t pipe_set_size(uint64_t id, uint64_t size) {
+	pipe_t *p = pipe_get_by_id(id);
+	if (!p)
+		return 0;
+	if (size == 0)
+		return p->capacity;
+
+	size_t capacity = pipe_round_size(size);
+	if (capacity == 0)
+		return 0;
+
+	if (!sem_wait_by_id(p->mutex))
+		return 0;
+	if (capacity == p->capacity) {
+		sem_signal_by_id(p->mutex);
+		return capacity;
+	}
+	char *buffer = (capacity >= p->count) ? (char *) mm_alloc(capacity) : NULL;
+	if (!buffer) {
+		sem_signal_by_id(p->mutex);
+		return 0;
+	}
+
+	size_t first = p->capacity - p->read_pos;
+	if (first > p->count)
+		first = p->count;
+	memcpy(buffer, p->buffer + p->read_pos, first);
+	memcpy(buffer + first, p->buffer, p->count - first);
+	mm_free(p->buffer);
+	p->buffer = buffer;
+	p->capacity = capacity;
+	p->read_pos = 0;
+	p->write_pos = (p->count == capacity) ? 0 : p->count;
+
+	wake_writers(p);
+	sem_signal_by_id(p->mutex);
+	return capacity;
+}
+
+/*
+ * Encola [base, base + size), un bloque del heap del kernel, como parte del contenido del pipe sin copiarlo.
+ * Si devuelve 1 el bloque pasa a ser del pipe, que lo libera con mm_free cuando se termina de leer; si
+ * devuelve 0 (no quedan lectores) sigue siendo del llamador.
+ */
+int pipe_gift(pipe_t *p, void *base, size_t size) {
+	if (!p || !base || size == 0) {
+		return 0;
+	}
+
+	if (!sem_wait_by_id(p->mutex)) {
+		return 0;
+	}
+
+	while (p->readers > 0 && p->gift_count >= PIPE_MAX_GIFTS) {
+		if (!wait_unlocked(p, p->sem_spaces, &p->writers_waiting)) {
+			return 0;
 		}
-		else {
-			sem_signal_by_id(p->mutex);
+	}
 
-			if (!sem_wait_by_id(p->sem_spaces)) {
+	pipe_gift_t *g = (p->readers > 0) ? (pipe_gift_t *) slab_alloc(gift_cache) : NULL;
+	if (!g) {
+		sem_signal_by_id(p->mutex);
+		return 0;
+	}
+	g->base = (char *) base;
+	g->size = size;
+	g->offset = 0;
+	gift_push(p, g);
+
+	wake_readers(p);
+	sem_signal_by_id(p->mutex);
+	return 1;
+}
+
+/*
+ * Mueve hasta count bytes de in a out con los dos mutex tomados. Un regalo que entra entero se pasa de
+ * una cola a la otra sin copiar; el resto se copia de buffer a buffer. Se detiene cuando out se llena.
+ */
+static size_t splice_locked(pipe_t *in, pipe_t *out, size_t count) {
+	size_t moved = 0;
+	while (moved < count && pipe_available(in) > 0) {
+		size_t space = out->capacity - out->count;
+		size_t n = ring_readable(in);
+		if (n > 0) {
+			if (n > count - moved)
+				n = count - moved;
+			if (n > space)
+				n = space;
+			if (n == 0)
 				break;
+			// Se copia por tramos contiguos de in; ring_put da la vuelta en out si hace falta
+			size_t left = n;
+			while (left > 0) {
+				size_t piece = in->capacity - in->read_pos;
+				if (piece > left)
+					piece = left;
+				ring_put(out, in->buffer + in->read_pos, piece);
+				ring_consume(in, piece);
+				left -= piece;
 			}
 		}
+		else {
+			pipe_gift_t *g = in->gift_head;
+			n = g->size - g->offset;
+			if (n <= count - moved && out->gift_count < PIPE_MAX_GIFTS) {
+				gift_push(out, gift_pop(in));
+			}
+			else {
+				if (n > count - moved)
+					n = count - moved;
+				if (n > space)
+					n = space;
+				if (n == 0)
+					break;
+				ring_put(out, g->base + g->offset, n);
+				gift_consume(in, n);
+			}
+		}
+		moved += n;
+	}
+	return moved;
+}
+
+// Toma los mutex de a y b siempre en orden de slot, asi dos splice cruzados no se bloquean entre si
+static int lock_pair(pipe_t *a, pipe_t *b) {
+	if ((a->id & PIPE_ID_INDEX_MASK) > (b->id & PIPE_ID_INDEX_MASK)) {
+		pipe_t *t = a;
+		a = b;
+		b = t;
+	}
+	if (!sem_wait_by_id(a->mutex))
+		return 0;
+	if (!sem_wait_by_id(b->mutex)) {
+		sem_signal_by_id(a->mutex);
+		return 0;
 	}
+	return 1;
+}
 
-	return (int) bytes_written;
+static void unlock_pair(pipe_t *a, pipe_t *b) {
+	sem_signal_by_id(a->mutex);
+	sem_signal_by_id(b->mutex);
+}
+
+/*
+ * Pasa datos de in a out dentro del kernel, sin copiarlos a userland. Espera como pipe_read a que in tenga
+ * datos y, si out esta lleno, a que tenga lugar. Nunca espera con un mutex tomado ademas del del pipe por
+ * el que espera; al despertar suelta todo y vuelve a tomar los dos en orden. Devuelve los bytes movidos:
+ * 0 si in llego a EOF o si out no tiene lectores.
+ */
+int pipe_splice(pipe_t *in, pipe_t *out, size_t count) {
+	if (!in || !out || in == out || count == 0) {
+		return 0;
+	}
+
+	for (;;) {
+		if (!lock_pair(in, out)) {
+			return 0;
+		}
+		if (out->readers == 0 || (pipe_available(in) == 0 && in->writers == 0)) {
+			unlock_pair(in, out);
+			return 0;
+		}
+
+		if (pipe_available(in) == 0) {
+			sem_signal_by_id(out->mutex);
+			if (!wait_unlocked(in, in->sem_items, &in->readers_waiting)) {
+				return 0;
+			}
+			sem_signal_by_id(in->mutex);
+			continue;
+		}
+
+		size_t moved = splice_locked(in, out, count);
+		if (moved > 0) {
+			wake_writers(in);
+			wake_readers(out);
+			unlock_pair(in, out);
+			return (int) moved;
+		}
+
+		sem_signal_by_id(in->mutex);
+		if (!wait_unlocked(out, out->sem_spaces, &out->writers_waiting)) {
+			return 0;
+		}
+		sem_signal_by_id(out->mutex);
+	}
+}
+
+// Eventos listos en una punta de p; se leen sin el mutex porque la syscall no puede ser interrumpida
+int pipe_poll(pipe_t *p, int is_writer) {
+	if (!p)
+		return POLL_NVAL;
+	if (is_writer) {
+		if (p->readers == 0)
+			return POLL_HUP;
+		return (p->count < p->capacity) ? POLL_OUT : 0;
+	}
+	int events = (pipe_available(p) > 0) ? POLL_IN : 0;
+	if (p->writers == 0)
+		events |= POLL_HUP;
+	return events;
+}
+
+wait_queue_t *pipe_wait_queue(pipe_t *p, int is_writer) {
+	if (!p)
+		return NULL;
+	return is_writer ? &p->write_queue : &p->read_queue;
 }
@@ -0,0 +1,157 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <keyboardDriver.h>
+#include <pipe.h>
+#include <poll.h>
+#include <process.h>
+#include <scheduler.h>
+#include <stddef.h>
+#include <time.h>
+
+#define STDIN 0
+#define STDOUT 1
+
+/*
+ * Las syscalls corren con las interrupciones deshabilitadas, asi que entre mirar los fds y bloquearse no
+ * puede cambiar nada: un proceso se anota en las colas de todos sus fds, se bloquea, y el primer pipe (o
+ * tecla) que cambia lo despierta. Al volver se saca de las colas y vuelve a mirar todo.
+ */
+
+// Procesos bloqueados en poll con tiempo limite
+static process_t *timed_head = NULL;
+
+void wait_queue_wake_all(wait_queue_t *q) {
+	for (poll_waiter_t *w = q->head; w; w = w->next) {
+		if (w->process->state == PROCESS_STATE_BLOCKED)
+			scheduler_unblock_process(w->process);
+	}
+}
+
+static void wait_queue_add(wait_queue_t *q, poll_waiter_t *w, process_t *p) {
+	w->process = p;
+	w->queue = q;
+	w->prev = NULL;
+	w->next = q->head;
+	if (q->head)
+		q->head->prev = w;
+	q->head = w;
+}
+
+static void wait_queue_remove(poll_waiter_t *w) {
+	if (w->prev)
+		w->prev->next = w->next;
+	else
+		w->queue->head = w->next;
+	if (w->next)
+		w->next->prev = w->prev;
+	w->next = w->prev = NULL;
+	w->queue = NULL;
+}
+
+// Eventos listos del fd y, si wait no es NULL, la cola donde esperar a que cambien
+static int fd_poll(process_t *p, int32_t fd, wait_queue_t **wait) {
+	if (wait)
+		*wait = NULL;
+	if (fd >= MAX_FDS)
+		return POLL_NVAL;
+
+	fd_entry_t *entry = &p->fds[fd];
+	if (entry->type == FD_TYPE_PIPE_READ || entry->type == FD_TYPE_PIPE_WRITE) {
+		if (!entry->pipe)
+			return POLL_NVAL;
+		int is_writer = (entry->type == FD_TYPE_PIPE_WRITE);
+		if (wait)
+			*wait = pipe_wait_queue(entry->pipe, is_writer);
+		return pipe_poll(entry->pipe, is_writer);
+	}
+
+	if (fd == STDOUT)
+		return POLL_OUT;
+	if (fd == STDIN) {
+		// En background leer la terminal bloquea, asi que nunca esta lista
+		if (wait)
+			*wait = keyboard_wait_queue();
+		return (p->is_foreground && keyboard_has_input()) ? POLL_IN : 0;
+	}
+	return POLL_NVAL;
+}
+
+static int64_t poll_scan(process_t *p, poll_fd_t *fds, uint64_t count) {
+	int64_t ready = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		fds[i].revents = 0;
+		if (fds[i].fd < 0)
+			continue;
+		// HUP y NVAL se informan aunque no se pidan
+		int events = fd_poll(p, fds[i].fd, NULL);
+		fds[i].revents = (int16_t) (events & (fds[i].events | POLL_HUP | POLL_NVAL));
+		if (fds[i].revents)
+			ready++;
+	}
+	return ready;
+}
+
+static void timed_remove(process_t *p) {
+	process_t **it = &timed_head;
+	while (*it && *it != p)
+		it = &(*it)->poll_timed_next;
+	if (*it)
+		*it = p->poll_timed_next;
+	p->poll_timed_next = NULL;
+	p->poll_deadline = 0;
+}
+
+void poll_cancel(process_t *p) {
+	for (int i = 0; i < p->poll_waiter_count; i++)
+		wait_queue_remove(&p->poll_waiters[i]);
+	p->poll_waiter_count = 0;
+	if (p->poll_deadline)
+		timed_remove(p);
+}
+
+// El proceso en ejecucion puede no haber llegado aun a la cola de bloqueados: se lo mira en el tick siguiente
+void poll_expire(uint64_t now) {
+	process_t *current = scheduler_current_process();
+	for (process_t *p = timed_head; p; p = p->poll_timed_next) {
+		if (p != current && p->poll_deadline <= now && p->state == PROCESS_STATE_BLOCKED)
+			scheduler_unblock_process(p);
+	}
+}
+
+int64_t poll_wait(poll_fd_t *fds, uint64_t count, int64_t timeout_ms) {
+	process_t *p = scheduler_current_process();
+	if (!p || !fds || count > MAX_FDS)
+		return -1;
+
+	uint64_t deadline = 0;
+	if (timeout_ms > 0) {
+		uint64_t ticks = ((uint64_t) timeout_ms * TIMER_HZ + 999) / 1000;
+		deadline = (uint64_t) ticks_elapsed() + ticks;
+	}
+
+	for (;;) {
+		int64_t ready = poll_scan(p, fds, count);
+		if (ready > 0 || timeout_ms == 0)
+			return ready;
+		if (deadline && (uint64_t) ticks_elapsed() >= deadline)
+			return 0;
+
+		for (uint64_t i = 0; i < count; i++) {
+			wait_queue_t *q;
+			if (fds[i].fd >= 0) {
+				fd_poll(p, fds[i].fd, &q);
+				if (q)
+					wait_queue_add(q, &p->poll_waiters[p->poll_waiter_count++], p);
+			}
+		}
+		if (deadline) {
+			p->poll_deadline = deadline;
+			p->poll_timed_next = timed_head;
+			timed_head = p;
+		}
+
+		scheduler_block_current();
+		scheduler_yield_current();
+		poll_cancel(p);
+	}
+}
@@ -2,12 +2,14 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <interrupts.h>
 #include <lib.h>
+#include <mm.h>
 #include <process.h>
 #include <scheduler.h>
 #include <semaphore.h>
+#include <slab.h>
 #include <stddef.h>
 
-#define MAX_SEMAPHORES 64
+#define SEM_TABLE_INITIAL 64
 
 typedef volatile uint8_t lock_t;
 
@@ -18,40 +20,93 @@ typedef struct semaphore_t {
 	lock_t lock;
 	process_t *wait_head;
 	process_t *wait_tail;
-	int used;
+	int slot; // posicion en sem_table
 } semaphore_t;
 
-static semaphore_t semaphores[MAX_SEMAPHORES];
-static uint64_t next_sem_id = 1;
-
-static semaphore_t *find_slot_by_id(uint64_t id) {
-	for (int i = 0; i < MAX_SEMAPHORES; ++i) {
-		if (semaphores[i].used && semaphores[i].id == id)
-			return &semaphores[i];
+typedef struct {
+	semaphore_t *sem;
+	uint32_t generation;
+	int32_t next_free; // siguiente slot libre o -1
+} sem_slot_t;
+
+/*
+ * Los semaforos salen de un slab y la tabla de slots se duplica cuando se llena, asi que la cantidad
+ * de semaforos (cada pipe usa tres) solo la limita la memoria. El id es el indice del slot mas uno en la
+ * parte baja y la generacion del slot en la alta: la busqueda es un acceso al arreglo y, como la
+ * generacion avanza al cerrar, un id viejo no encuentra al semaforo que reuso su slot.
+ */
+static slab_cache_t *sem_cache = NULL;
+static sem_slot_t *sem_table = NULL;
+static int sem_table_size = 0;
+static int sem_free_head = -1;
+
+// Devuelve una posicion libre de la tabla, agrandandola si hace falta; -1 sin memoria
+static int free_table_slot(void) {
+	if (sem_free_head < 0) {
+		int new_size = sem_table_size ? sem_table_size * 2 : SEM_TABLE_INITIAL;
+		sem_slot_t *table = (sem_slot_t *) mm_alloc(new_size * sizeof(sem_slot_t));
+		if (!table)
+			return -1;
+		if (sem_table) {
+			memcpy(table, sem_table, sem_table_size * sizeof(sem_slot_t));
+			mm_free(sem_table);
+		}
+		for (int i = sem_table_size; i < new_size; i++) {
+			table[i].sem = NULL;
+			table[i].generation = 1;
+			table[i].next_free = (i + 1 < new_size) ? i + 1 : -1;
+		}
+		sem_free_head = sem_table_size;
+		sem_table = table;
+		sem_table_size = new_size;
 	}
-	return NULL;
+
+	int slot = sem_free_head;
+	sem_free_head = sem_table[slot].next_free;
+	return slot;
+}
+
+static void release_table_slot(int slot) {
+	sem_table[slot].sem = NULL;
+	if (++sem_table[slot].generation == 0)
+		sem_table[slot].generation = 1;
+	sem_table[slot].next_free = sem_free_head;
+	sem_free_head = slot;
 }
 
 semaphore_t *sem_get_by_id(uint64_t id) {
-	if (id == 0)
+	uint64_t index = (id & 0xFFFFFFFFULL) - 1;
+	if (index >= (uint64_t) sem_table_size)
+		return NULL;
+	sem_slot_t *slot = &sem_table[index];
+	if (!slot->sem || slot->generation != (id >> 32))
 		return NULL;
-	return find_slot_by_id(id);
+	return slot->sem;
 }
 
 uint64_t sem_alloc(int initial_value) {
-	for (int i = 0; i < MAX_SEMAPHORES; ++i) {
-		if (!semaphores[i].used) {
-			semaphore_t *s = &semaphores[i];
-			s->used = 1;
-			s->id = next_sem_id++;
-			s->value = initial_value;
-			s->refcount = 1;
-			s->lock = 0;
-			s->wait_head = s->wait_tail = NULL;
-			return s->id;
-		}
+	if (!sem_cache)
+		sem_cache = slab_cache_create("semaphore_t", sizeof(semaphore_t), NULL);
+	if (!sem_cache)
+		return 0;
+
+	int slot = free_table_slot();
+	if (slot < 0)
+		return 0;
+	semaphore_t *s = (semaphore_t *) slab_alloc(sem_cache);
+	if (!s) {
+		release_table_slot(slot);
+		return 0;
 	}
-	return 0;
+
+	s->id = ((uint64_t) sem_table[slot].generation << 32) | (uint64_t) (slot + 1);
+	s->value = initial_value;
+	s->refcount = 1;
+	s->lock = 0;
+	s->wait_head = s->wait_tail = NULL;
+	s->slot = slot;
+	sem_table[slot].sem = s;
+	return s->id;
 }
 
 int sem_open_by_id(uint64_t id) {
@@ -73,10 +128,8 @@ int sem_close_by_id(uint64_t id) {
 	int ref = s->refcount;
 	release(&s->lock);
 	if (ref <= 0) {
-		acquire(&s->lock);
-		s->used = 0;
-		s->wait_head = s->wait_tail = NULL;
-		release(&s->lock);
+		release_table_slot(s->slot);
+		slab_free(sem_cache, s);
 	}
 	return 1;
 }
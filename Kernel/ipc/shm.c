@@ -0,0 +1,206 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <lib.h>
+#include <mm.h>
+#include <paging.h>
+#include <process.h>
+#include <shm.h>
+#include <stddef.h>
+
+struct shm_segment {
+	char name[SHM_NAME_MAX_LEN + 1];
+	void *base;
+	uint64_t size;
+	int refcount; // procesos adjuntos
+	int used;
+};
+
+static shm_segment_t segments[MAX_SHM_SEGMENTS];
+static volatile uint8_t shm_lock = 0;
+
+static int name_equals(const char *a, const char *b) {
+	for (int i = 0; i <= SHM_NAME_MAX_LEN; i++) {
+		if (a[i] != b[i])
+			return 0;
+		if (a[i] == '\0')
+			return 1;
+	}
+	return 1;
+}
+
+// 0 si el nombre es vacio o no entra en SHM_NAME_MAX_LEN
+static int copy_name(char *dest, const char *src) {
+	int i = 0;
+	while (i < SHM_NAME_MAX_LEN && src[i] != '\0') {
+		dest[i] = src[i];
+		i++;
+	}
+	dest[i] = '\0';
+	return i > 0 && src[i] == '\0';
+}
+
+static shm_segment_t *find_by_name(const char *name) {
+	for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+		if (segments[i].used && name_equals(segments[i].name, name))
+			return &segments[i];
+	}
+	return NULL;
+}
+
+static int find_attach_slot(process_t *p, shm_segment_t *seg) {
+	for (int i = 0; i < MAX_SHM_ATTACH; i++) {
+		if (p->shm_attached[i] == seg)
+			return i;
+	}
+	return -1;
+}
+
+// Saca la referencia del slot; si era la ultima, el segmento se libera fuera del lock
+static void *drop_attachment(process_t *p, int slot) {
+	shm_segment_t *seg = p->shm_attached[slot];
+	p->shm_attached[slot] = NULL;
+	if (--seg->refcount > 0)
+		return NULL;
+	void *base = seg->base;
+	seg->used = 0;
+	seg->base = NULL;
+	return base;
+}
+
+void *shm_create(process_t *p, const char *name, uint64_t size) {
+	char local_name[SHM_NAME_MAX_LEN + 1];
+	if (!p || !name || size == 0 || size > SHM_MAX_SIZE || !copy_name(local_name, name))
+		return NULL;
+
+	uint64_t bytes = (size + MM_PAGE_SIZE - 1) & ~(MM_PAGE_SIZE - 1);
+	void *base = mm_alloc_aligned(bytes, MM_PAGE_SIZE);
+	if (!base)
+		return NULL;
+	memset(base, 0, bytes);
+
+	acquire(&shm_lock);
+	int attach = find_attach_slot(p, NULL);
+	shm_segment_t *seg = NULL;
+	if (attach >= 0 && !find_by_name(local_name)) {
+		for (int i = 0; i < MAX_SHM_SEGMENTS; i++) {
+			if (!segments[i].used) {
+				seg = &segments[i];
+				break;
+			}
+		}
+	}
+	if (seg) {
+		copy_name(seg->name, local_name);
+		seg->base = base;
+		seg->size = bytes;
+		seg->refcount = 1;
+		seg->used = 1;
+		p->shm_attached[attach] = seg;
+	}
+	release(&shm_lock);
+
+	if (!seg) {
+		mm_free(base);
+		return NULL;
+	}
+	void *user = paging_map_user(p, base, bytes);
+	if (!user) {
+		acquire(&shm_lock);
+		void *to_free = drop_attachment(p, attach);
+		release(&shm_lock);
+		if (to_free)
+			mm_free(to_free);
+	}
+	return user;
+}
+
+void *shm_attach(process_t *p, const char *name, uint64_t *size_out) {
+	char local_name[SHM_NAME_MAX_LEN + 1];
+	if (!p || !name || !copy_name(local_name, name))
+		return NULL;
+
+	void *base = NULL;
+	uint64_t size = 0;
+	int new_slot = -1;
+	acquire(&shm_lock);
+	shm_segment_t *seg = find_by_name(local_name);
+	if (seg) {
+		int slot = find_attach_slot(p, seg);
+		if (slot < 0) {
+			slot = new_slot = find_attach_slot(p, NULL);
+			if (slot >= 0) {
+				p->shm_attached[slot] = seg;
+				seg->refcount++;
+			}
+		}
+		if (slot >= 0) {
+			base = seg->base;
+			size = seg->size;
+		}
+	}
+	release(&shm_lock);
+	if (!base)
+		return NULL;
+
+	// La referencia ya tomada mantiene vivo el segmento mientras se mapea fuera del lock
+	void *user = paging_phys_to_user(base);
+	if (new_slot >= 0 && !(user = paging_map_user(p, base, size))) {
+		acquire(&shm_lock);
+		void *to_free = drop_attachment(p, new_slot);
+		release(&shm_lock);
+		if (to_free)
+			mm_free(to_free);
+		return NULL;
+	}
+	if (size_out)
+		*size_out = size;
+	return user;
+}
+
+int shm_detach(process_t *p, void *addr) {
+	if (!p || !addr)
+		return 0;
+
+	int found = 0;
+	uint64_t size = 0;
+	void *to_free = NULL;
+	void *base = paging_user_to_phys(addr);
+	acquire(&shm_lock);
+	for (int i = 0; i < MAX_SHM_ATTACH; i++) {
+		if (p->shm_attached[i] && p->shm_attached[i]->base == base) {
+			size = p->shm_attached[i]->size;
+			to_free = drop_attachment(p, i);
+			found = 1;
+			break;
+		}
+	}
+	release(&shm_lock);
+
+	if (found)
+		paging_unmap_user(p, paging_phys_to_user(base), size);
+	if (to_free)
+		mm_free(to_free);
+	return found;
+}
+
+void shm_detach_all(process_t *p) {
+	if (!p)
+		return;
+
+	for (int i = 0; i < MAX_SHM_ATTACH; i++) {
+		void *base = NULL;
+		uint64_t size = 0;
+		void *to_free = NULL;
+		acquire(&shm_lock);
+		if (p->shm_attached[i]) {
+			base = p->shm_attached[i]->base;
+			size = p->shm_attached[i]->size;
+			to_free = drop_attachment(p, i);
+		}
+		release(&shm_lock);
+		if (base)
+			paging_unmap_user(p, paging_phys_to_user(base), size);
+		if (to_free)
+			mm_free(to_free);
+	}
+}
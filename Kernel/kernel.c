@@ -1,11 +1,13 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <gdt.h>
 #include <idtLoader.h>
 #include <interrupts.h>
 #include <keyboardDriver.h>
 #include <lib.h>
 #include <mm.h>
 #include <moduleLoader.h>
+#include <paging.h>
 #include <pipe.h>
 #include <scheduler.h>
 
@@ -18,6 +20,9 @@ extern uint8_t endOfKernel;
 
 static const uint64_t PageSize = 0x1000;
 
+// Fin de los modulos de userland: mm_init_default no usa memoria por debajo
+uint64_t endOfModules = 0;
+
 static void *const sampleCodeModuleAddress = (void *) 0x400000;
 static void *const sampleDataModuleAddress = (void *) 0x500000;
 
@@ -40,9 +45,10 @@ void idle() {
 void *initializeKernelBinary() {
 	void *moduleAddresses[] = {sampleCodeModuleAddress, sampleDataModuleAddress};
 
-	loadModules((&endOfKernelBinary), moduleAddresses);
+	uint64_t modulesEnd = loadModules((&endOfKernelBinary), moduleAddresses);
 
 	clearBSS(&bss, (uint64_t) (uintptr_t) &endOfKernel - (uint64_t) (uintptr_t) &bss);
+	endOfModules = modulesEnd;
 
 	return getStackBase();
 }
@@ -50,12 +56,14 @@ void *initializeKernelBinary() {
 int main() {
 	_cli();
 	mm_init_default();
+	paging_init();
 	init_scheduler();
 	pipe_system_init();
 	keyboard_init();
 
 	scheduler_spawn_process("shell", (void *) sampleCodeModuleAddress, NULL, NULL, 2, 1, 0, 0);
 
+	load_gdt_tss();
 	load_idt();
 	_sti();
 
@@ -5,10 +5,22 @@
 
 void *memset(void *destination, int32_t c, uint64_t length) {
 	uint8_t chr = (uint8_t) c;
-	char *dst = (char *) destination;
+	uint8_t *dst = (uint8_t *) destination;
 
+	// Bytes sueltos hasta alinear a 8 y despues una palabra de 64 bits por escritura
+	while (length && ((uint64_t) dst & (sizeof(uint64_t) - 1))) {
+		*dst++ = chr;
+		length--;
+	}
+
+	uint64_t word = chr * 0x0101010101010101ULL;
+	uint64_t *dst64 = (uint64_t *) dst;
+	for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t))
+		*dst64++ = word;
+
+	dst = (uint8_t *) dst64;
 	while (length--)
-		dst[length] = chr;
+		*dst++ = chr;
 
 	return destination;
 }
@@ -5,19 +5,24 @@
 #include <naiveConsole.h>
 #include <stdint.h>
 
-static void loadModule(uint8_t **module, void *targetModuleAddress);
+static uint64_t loadModule(uint8_t **module, void *targetModuleAddress);
 static uint32_t readUint32(uint8_t **address);
 
-void loadModules(void *payloadStart, void **targetModuleAddress) {
+uint64_t loadModules(void *payloadStart, void **targetModuleAddress) {
 	int i;
 	uint8_t *currentModule = (uint8_t *) payloadStart;
 	uint32_t moduleCount = readUint32(&currentModule);
-
-	for (i = 0; i < moduleCount; i++)
-		loadModule(&currentModule, targetModuleAddress[i]);
+	uint64_t end = 0;
+
+	for (i = 0; i < moduleCount; i++) {
+		uint64_t moduleEnd = loadModule(&currentModule, targetModuleAddress[i]);
+		if (moduleEnd > end)
+			end = moduleEnd;
+	}
+	return end;
 }
 
-static void loadModule(uint8_t **module, void *targetModuleAddress) {
+static uint64_t loadModule(uint8_t **module, void *targetModuleAddress) {
 	uint32_t moduleSize = readUint32(module);
 
 	ncPrint("  Will copy module at 0x");
@@ -33,6 +38,7 @@ static void loadModule(uint8_t **module, void *targetModuleAddress) {
 
 	ncPrint(" [Done]");
 	ncNewline();
+	return (uint64_t) targetModuleAddress + moduleSize;
 }
 
 static uint32_t readUint32(uint8_t **address) {
@@ -0,0 +1,80 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <memory_map.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MEMORY_MAP_PAGE_SIZE 0x1000ULL
+
+static inline uint64_t page_up(uint64_t value) {
+	return (value + MEMORY_MAP_PAGE_SIZE - 1) & ~(MEMORY_MAP_PAGE_SIZE - 1);
+}
+
+static inline uint64_t page_down(uint64_t value) {
+	return value & ~(MEMORY_MAP_PAGE_SIZE - 1);
+}
+
+static void insert_sorted(memory_region_t *regions, uint64_t count, memory_region_t region) {
+	uint64_t i = count;
+	while (i > 0 && regions[i - 1].start > region.start) {
+		regions[i] = regions[i - 1];
+		i--;
+	}
+	regions[i] = region;
+}
+
+uint64_t memory_map_usable_regions(memory_region_t *regions, uint64_t max_regions, uint64_t reserved_end) {
+	if (regions == NULL || max_regions == 0)
+		return 0;
+
+	const e820_entry_t *map = (const e820_entry_t *) E820_MAP_ADDRESS;
+	uint64_t count = 0;
+
+	for (int i = 0; i < E820_MAX_ENTRIES && map[i].length != 0; i++) {
+		if (map[i].type != E820_TYPE_USABLE)
+			continue;
+
+		uint64_t start = map[i].base;
+		uint64_t end = (map[i].base + map[i].length < map[i].base) ? MEMORY_MAP_MAPPED_LIMIT
+																   : map[i].base + map[i].length;
+		if (start < reserved_end)
+			start = reserved_end;
+		if (end > MEMORY_MAP_MAPPED_LIMIT)
+			end = MEMORY_MAP_MAPPED_LIMIT;
+		start = page_up(start);
+		end = page_down(end);
+		if (start >= end)
+			continue;
+
+		// Si no entran todas, se descarta la region mas chica entre la nueva y las ya guardadas
+		memory_region_t region = {start, end};
+		if (count == max_regions) {
+			uint64_t smallest = 0;
+			for (uint64_t j = 1; j < count; j++) {
+				if (regions[j].end - regions[j].start < regions[smallest].end - regions[smallest].start)
+					smallest = j;
+			}
+			if (regions[smallest].end - regions[smallest].start >= end - start)
+				continue;
+			for (uint64_t j = smallest; j + 1 < count; j++)
+				regions[j] = regions[j + 1];
+			count--;
+		}
+		insert_sorted(regions, count, region);
+		count++;
+	}
+
+	// Algunos BIOS reportan entradas solapadas: cada region arranca donde termina la anterior
+	uint64_t out = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		if (out > 0 && regions[i].start < regions[out - 1].end)
+			regions[i].start = regions[out - 1].end;
+		if (regions[i].start < regions[i].end)
+			regions[out++] = regions[i];
+	}
+	return out;
+}
+
+uint64_t memory_map_total_mb(void) {
+	return *(const uint32_t *) PURE64_MEM_AMOUNT_ADDRESS;
+}
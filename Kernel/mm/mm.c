@@ -0,0 +1,691 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <lib.h>
+#include <memory_map.h>
+#include <mm_backend.h>
+#include <mm_profile.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Capa de magazines (Bonwick) delante de cada heap. Cada CPU tiene, por clase de tamaño, un magazine
+ * cargado y uno previo con bloques liberados hace poco; alloc/free los usan sin tomar el lock.
+ * Solo al vaciarse o llenarse ambos se pasa por el depot del heap, que junto con el backend va bajo mm_lock.
+ */
+
+#define MM_MAX_CPUS 1 // sin SMP: un unico slot de CPU
+#define MM_MAG_ROUNDS 16
+#define MM_MAG_REFILL (MM_MAG_ROUNDS / 2)
+#define MM_CLASS_MIN_LOG2 5
+#define MM_CLASS_MAX_LOG2 12
+#define MM_CLASS_COUNT (MM_CLASS_MAX_LOG2 - MM_CLASS_MIN_LOG2 + 1)
+#define MM_DEPOT_FULL_MAX 4
+#define MM_MAG_POOL_SIZE (MM_CLASS_COUNT * (2 * MM_MAX_CPUS + MM_DEPOT_FULL_MAX))
+
+/*
+ * Pool de bloques pre-cerados por clase de paginas (4 KB a 64 KB): el proceso idle los pide al backend,
+ * los pone en cero con interrupciones habilitadas y los deja aca para que mm_alloc_zeroed no pague el memset.
+ */
+#define MM_ZERO_CLASS_MIN_LOG2 12
+#define MM_ZERO_CLASS_MAX_LOG2 16
+#define MM_ZERO_CLASS_COUNT (MM_ZERO_CLASS_MAX_LOG2 - MM_ZERO_CLASS_MIN_LOG2 + 1)
+#define MM_ZERO_POOL_DEPTH 4
+// El idle no pre-cera si el backend tiene menos libre que esto
+#define MM_ZERO_MIN_FREE (8ULL * 1024 * 1024)
+
+#define MM_KERNEL_STACK_PAGES 8ULL
+// Limite del heap si el bootloader no encontro mapa E820
+#define MM_FALLBACK_HEAP_LIMIT 0x20000000ULL
+// Los heaps secundarios solo se arman si a la region mas grande le queda al menos esto para el heap 0
+#define MM_PRIMARY_MIN_SIZE (64ULL * 1024 * 1024)
+
+#if defined(USE_BUDDY_MM)
+#define MM_PRIMARY_ALLOCATOR mm_buddy_allocator
+#elif defined(USE_TLSF_MM)
+#define MM_PRIMARY_ALLOCATOR mm_tlsf_allocator
+#else
+#define MM_PRIMARY_ALLOCATOR mm_simple_allocator
+#endif
+
+extern uint8_t endOfKernel;
+extern uint64_t endOfModules;
+
+typedef struct magazine {
+	struct magazine *next;
+	uint64_t count;
+	void *rounds[MM_MAG_ROUNDS];
+} magazine_t;
+
+typedef struct {
+	magazine_t *loaded;
+	magazine_t *previous;
+} mag_slot_t;
+
+typedef struct {
+	mag_slot_t slots[MM_CLASS_COUNT];
+} cpu_cache_t;
+
+typedef struct {
+	const mm_allocator_t *ops;
+	memory_region_t regions[MM_MAX_REGIONS]; // para saber a que heap devolver cada bloque
+	uint64_t region_count;
+
+	magazine_t magazine_pool[MM_MAG_POOL_SIZE];
+	magazine_t *depot_full[MM_CLASS_COUNT];
+	uint64_t depot_full_count[MM_CLASS_COUNT];
+	magazine_t *depot_empty;
+	cpu_cache_t cpu_caches[MM_MAX_CPUS];
+	uint8_t caches_ready;
+
+	void *zero_pool[MM_ZERO_CLASS_COUNT][MM_ZERO_POOL_DEPTH];
+	uint64_t zero_pool_count[MM_ZERO_CLASS_COUNT];
+	uint64_t zeroed_bytes;
+
+	uint64_t cached_bytes; // bytes utilizables de los bloques guardados en magazines y en el pool
+	uint64_t allocation_count;
+	uint64_t free_count;
+	uint64_t failed_count;
+} mm_heap_t;
+
+static mm_heap_t heaps[MM_MAX_HEAPS];
+static int heap_count = 0;
+static uint8_t use_heap[MM_USE_COUNT];
+static int zero_next_heap = 0;
+static volatile uint8_t mm_lock = 0;
+
+static inline int current_cpu(void) {
+	return 0;
+}
+
+static inline uint64_t class_size(int cls) {
+	return 1ULL << (cls + MM_CLASS_MIN_LOG2);
+}
+
+// Clase mas chica que alcanza para el pedido, o -1 si es mayor a la ultima clase
+static int class_for_alloc(uint64_t size) {
+	if (size > class_size(MM_CLASS_COUNT - 1))
+		return -1;
+	if (size <= class_size(0))
+		return 0;
+	return (64 - __builtin_clzll(size - 1)) - MM_CLASS_MIN_LOG2;
+}
+
+// Clase mas grande que entra en el bloque; bloques de mas del doble de la ultima clase no se cachean
+static int class_for_free(uint64_t usable) {
+	if (usable < class_size(0) || usable >= 2 * class_size(MM_CLASS_COUNT - 1))
+		return -1;
+	return (63 - __builtin_clzll(usable)) - MM_CLASS_MIN_LOG2;
+}
+
+static void caches_init(mm_heap_t *h) {
+	int next = 0;
+	for (int cpu = 0; cpu < MM_MAX_CPUS; cpu++) {
+		for (int cls = 0; cls < MM_CLASS_COUNT; cls++) {
+			mag_slot_t *slot = &h->cpu_caches[cpu].slots[cls];
+			slot->loaded = &h->magazine_pool[next++];
+			slot->previous = &h->magazine_pool[next++];
+			slot->loaded->count = 0;
+			slot->previous->count = 0;
+		}
+	}
+	h->depot_empty = NULL;
+	for (; next < MM_MAG_POOL_SIZE; next++) {
+		h->magazine_pool[next].count = 0;
+		h->magazine_pool[next].next = h->depot_empty;
+		h->depot_empty = &h->magazine_pool[next];
+	}
+	for (int cls = 0; cls < MM_CLASS_COUNT; cls++) {
+		h->depot_full[cls] = NULL;
+		h->depot_full_count[cls] = 0;
+	}
+	for (int zc = 0; zc < MM_ZERO_CLASS_COUNT; zc++)
+		h->zero_pool_count[zc] = 0;
+	h->zeroed_bytes = 0;
+	h->cached_bytes = 0;
+	h->caches_ready = 1;
+}
+
+static void magazine_drain(mm_heap_t *h, magazine_t *mag) {
+	while (mag->count > 0) {
+		void *ptr = mag->rounds[--mag->count];
+		h->cached_bytes -= h->ops->usable_size(ptr);
+		h->ops->free(ptr);
+	}
+}
+
+// Devuelve al backend todos los bloques cacheados para que pueda volver a unirlos; se llama con mm_lock tomado
+static void caches_flush(mm_heap_t *h) {
+	for (int cpu = 0; cpu < MM_MAX_CPUS; cpu++) {
+		for (int cls = 0; cls < MM_CLASS_COUNT; cls++) {
+			magazine_drain(h, h->cpu_caches[cpu].slots[cls].loaded);
+			magazine_drain(h, h->cpu_caches[cpu].slots[cls].previous);
+		}
+	}
+	for (int zc = 0; zc < MM_ZERO_CLASS_COUNT; zc++) {
+		while (h->zero_pool_count[zc] > 0) {
+			void *ptr = h->zero_pool[zc][--h->zero_pool_count[zc]];
+			uint64_t usable = h->ops->usable_size(ptr);
+			h->cached_bytes -= usable;
+			h->zeroed_bytes -= usable;
+			h->ops->free(ptr);
+		}
+	}
+	for (int cls = 0; cls < MM_CLASS_COUNT; cls++) {
+		while (h->depot_full[cls]) {
+			magazine_t *mag = h->depot_full[cls];
+			h->depot_full[cls] = mag->next;
+			magazine_drain(h, mag);
+			mag->next = h->depot_empty;
+			h->depot_empty = mag;
+		}
+		h->depot_full_count[cls] = 0;
+	}
+}
+
+static inline void swap_magazines(mag_slot_t *slot) {
+	magazine_t *tmp = slot->loaded;
+	slot->loaded = slot->previous;
+	slot->previous = tmp;
+}
+
+// Se llama con interrupciones deshabilitadas
+static void *cache_pop(mm_heap_t *h, int cls) {
+	mag_slot_t *slot = &h->cpu_caches[current_cpu()].slots[cls];
+
+	if (slot->loaded->count == 0 && slot->previous->count > 0)
+		swap_magazines(slot);
+
+	if (slot->loaded->count == 0) {
+		acquire(&mm_lock);
+		if (h->depot_full[cls]) {
+			magazine_t *full = h->depot_full[cls];
+			h->depot_full[cls] = full->next;
+			h->depot_full_count[cls]--;
+			slot->loaded->next = h->depot_empty;
+			h->depot_empty = slot->loaded;
+			slot->loaded = full;
+		}
+		else {
+			// Recarga en lote: varios bloques del backend con una sola toma del lock
+			magazine_t *mag = slot->loaded;
+			while (mag->count < MM_MAG_REFILL) {
+				void *ptr = h->ops->alloc(class_size(cls));
+				if (!ptr)
+					break;
+				mag->rounds[mag->count++] = ptr;
+				h->cached_bytes += h->ops->usable_size(ptr);
+			}
+		}
+		release(&mm_lock);
+	}
+
+	if (slot->loaded->count == 0)
+		return NULL;
+	void *ptr = slot->loaded->rounds[--slot->loaded->count];
+	h->cached_bytes -= h->ops->usable_size(ptr);
+	return ptr;
+}
+
+// Se llama con interrupciones deshabilitadas; devuelve 0 si el bloque tiene que ir al backend
+static int cache_push(mm_heap_t *h, int cls, void *ptr, uint64_t usable) {
+	mag_slot_t *slot = &h->cpu_caches[current_cpu()].slots[cls];
+
+	if (slot->loaded->count == MM_MAG_ROUNDS && slot->previous->count == 0)
+		swap_magazines(slot);
+
+	if (slot->loaded->count == MM_MAG_ROUNDS) {
+		acquire(&mm_lock);
+		if (h->depot_full_count[cls] >= MM_DEPOT_FULL_MAX || !h->depot_empty) {
+			release(&mm_lock);
+			return 0;
+		}
+		slot->previous->next = h->depot_full[cls];
+		h->depot_full[cls] = slot->previous;
+		h->depot_full_count[cls]++;
+		slot->previous = slot->loaded;
+		slot->loaded = h->depot_empty;
+		h->depot_empty = h->depot_empty->next;
+		release(&mm_lock);
+	}
+
+	slot->loaded->rounds[slot->loaded->count++] = ptr;
+	h->cached_bytes += usable;
+	return 1;
+}
+
+// Arma un heap sobre regions con el backend ops; se llama con mm_lock tomado
+static void heap_setup(mm_heap_t *h, const mm_allocator_t *ops, const memory_region_t *regions, uint64_t count) {
+	h->ops = ops;
+	h->region_count = 0;
+	for (uint64_t i = 0; i < count && i < MM_MAX_REGIONS; i++) {
+		if (h->region_count == 0)
+			ops->init((void *) regions[i].start, regions[i].end - regions[i].start);
+		else
+			ops->add_region((void *) regions[i].start, regions[i].end - regions[i].start);
+		h->regions[h->region_count++] = regions[i];
+	}
+	caches_init(h);
+	h->allocation_count = h->free_count = h->failed_count = 0;
+}
+
+static void uses_reset(void) {
+	for (int u = 0; u < MM_USE_COUNT; u++)
+		use_heap[u] = 0;
+}
+
+void mm_init(void *heap_start, uint64_t heap_size) {
+	memory_region_t region = {(uint64_t) heap_start, (uint64_t) heap_start + heap_size};
+	uint64_t flags = irq_save();
+	acquire(&mm_lock);
+	heap_setup(&heaps[0], &MM_PRIMARY_ALLOCATOR, &region, 1);
+	heap_count = 1;
+	uses_reset();
+	release(&mm_lock);
+	irq_restore(flags);
+}
+
+// Todo lo que esta debajo del stack del kernel o de los modulos de userland queda fuera del heap
+static uint64_t reserved_end(void) {
+	uint64_t end = (uint64_t) &endOfKernel + MM_PAGE_SIZE * MM_KERNEL_STACK_PAGES;
+	return (endOfModules > end) ? endOfModules : end;
+}
+
+/*
+ * El heap 0 usa todas las regiones del mapa E820. Si la region mas grande alcanza, de su final se separa un
+ * heap de MM_SECONDARY_HEAP_SIZE por cada uno de los otros backends, alineado a 2 MB.
+ */
+void mm_init_default(void) {
+	memory_region_t regions[MM_MAX_REGIONS];
+	uint64_t low = reserved_end();
+	uint64_t count = memory_map_usable_regions(regions, MM_MAX_REGIONS, low);
+	if (count == 0 && low < MM_FALLBACK_HEAP_LIMIT) {
+		regions[0].start = low;
+		regions[0].end = MM_FALLBACK_HEAP_LIMIT;
+		count = 1;
+	}
+	if (count == 0)
+		return;
+
+	uint64_t largest = 0;
+	for (uint64_t i = 1; i < count; i++) {
+		if (regions[i].end - regions[i].start > regions[largest].end - regions[largest].start)
+			largest = i;
+	}
+	const mm_allocator_t *all[] = {&mm_simple_allocator, &mm_buddy_allocator, &mm_tlsf_allocator};
+	memory_region_t secondary[MM_MAX_HEAPS - 1];
+	const mm_allocator_t *secondary_ops[MM_MAX_HEAPS - 1];
+	int secondary_count = 0;
+	uint64_t carve_end = regions[largest].end & ~(MM_LARGE_PAGE_SIZE - 1);
+	for (int i = 0; i < MM_MAX_HEAPS; i++) {
+		if (all[i] == &MM_PRIMARY_ALLOCATOR)
+			continue;
+		if (carve_end < regions[largest].start + MM_PRIMARY_MIN_SIZE + MM_SECONDARY_HEAP_SIZE)
+			break;
+		carve_end -= MM_SECONDARY_HEAP_SIZE;
+		secondary[secondary_count].start = carve_end;
+		secondary[secondary_count].end = carve_end + MM_SECONDARY_HEAP_SIZE;
+		secondary_ops[secondary_count++] = all[i];
+	}
+	if (secondary_count > 0)
+		regions[largest].end = carve_end;
+
+	uint64_t flags = irq_save();
+	acquire(&mm_lock);
+	heap_setup(&heaps[0], &MM_PRIMARY_ALLOCATOR, regions, count);
+	for (int i = 0; i < secondary_count; i++)
+		heap_setup(&heaps[i + 1], secondary_ops[i], &secondary[i], 1);
+	heap_count = 1 + secondary_count;
+	uses_reset();
+	release(&mm_lock);
+	irq_restore(flags);
+}
+
+static inline int heaps_ready(void) {
+	return heap_count > 0 && heaps[0].ops->is_initialized();
+}
+
+static mm_heap_t *heap_for_use(mm_use_t use) {
+	if (!heaps_ready())
+		mm_init_default();
+	if ((unsigned) use >= MM_USE_COUNT)
+		use = MM_USE_GENERAL;
+	return &heaps[use_heap[use]];
+}
+
+// Heap que contiene ptr; los punteros que no caen en ninguna region se le dejan al heap 0 como antes
+static mm_heap_t *heap_of(void *ptr) {
+	uint64_t addr = (uint64_t) ptr;
+	for (int i = 1; i < heap_count; i++) {
+		for (uint64_t r = 0; r < heaps[i].region_count; r++) {
+			if (addr >= heaps[i].regions[r].start && addr < heaps[i].regions[r].end)
+				return &heaps[i];
+		}
+	}
+	return &heaps[0];
+}
+
+/*
+ * Las funciones publicas registran en el profiler con su propia direccion de retorno; entre ellas se llaman
+ * por estas versiones internas para que el sitio informado sea el del llamador original.
+ */
+static void *alloc_block(mm_heap_t *h, uint64_t size) {
+	if (size == 0)
+		return NULL;
+
+	uint64_t flags = irq_save();
+	if (!h->caches_ready)
+		caches_init(h);
+
+	int cls = class_for_alloc(size);
+	void *ptr = (cls >= 0) ? cache_pop(h, cls) : NULL;
+	if (!ptr) {
+		uint64_t request = (cls >= 0) ? class_size(cls) : size;
+		acquire(&mm_lock);
+		ptr = h->ops->alloc(request);
+		if (!ptr && h->cached_bytes > 0) {
+			caches_flush(h);
+			ptr = h->ops->alloc(request);
+		}
+		release(&mm_lock);
+	}
+
+	if (ptr)
+		h->allocation_count++;
+	else
+		h->failed_count++;
+	irq_restore(flags);
+	return ptr;
+}
+
+void *mm_alloc(uint64_t size) {
+	void *ptr = alloc_block(heap_for_use(MM_USE_GENERAL), size);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+void *mm_alloc_for(mm_use_t use, uint64_t size) {
+	void *ptr = alloc_block(heap_for_use(use), size);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+// No pasa por los magazines: sus bloques solo garantizan MM_ALIGNMENT
+static void *alloc_aligned_block(mm_heap_t *h, uint64_t size, uint64_t align) {
+	if (size == 0 || align == 0 || (align & (align - 1)) || align > MM_MAX_ALIGN)
+		return NULL;
+
+	uint64_t flags = irq_save();
+	acquire(&mm_lock);
+	void *ptr = h->ops->alloc_aligned(size, align);
+	if (!ptr && h->cached_bytes > 0) {
+		caches_flush(h);
+		ptr = h->ops->alloc_aligned(size, align);
+	}
+	release(&mm_lock);
+
+	if (ptr)
+		h->allocation_count++;
+	else
+		h->failed_count++;
+	irq_restore(flags);
+	return ptr;
+}
+
+void *mm_alloc_aligned(uint64_t size, uint64_t align) {
+	void *ptr = alloc_aligned_block(heap_for_use(MM_USE_GENERAL), size, align);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+void *mm_alloc_aligned_for(mm_use_t use, uint64_t size, uint64_t align) {
+	void *ptr = alloc_aligned_block(heap_for_use(use), size, align);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+void *mm_alloc_pages(uint8_t order) {
+	if (order > MM_MAX_PAGE_ORDER)
+		return NULL;
+	uint64_t size = MM_PAGE_SIZE << order;
+	void *ptr = alloc_aligned_block(heap_for_use(MM_USE_PAGES), size, size);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+static inline uint64_t zero_class_size(int zc) {
+	return 1ULL << (zc + MM_ZERO_CLASS_MIN_LOG2);
+}
+
+// Clase del pool que sirve sin desperdiciar mas de la mitad del bloque, o -1
+static int zero_class_for(uint64_t size) {
+	if (size <= zero_class_size(0) / 2 || size > zero_class_size(MM_ZERO_CLASS_COUNT - 1))
+		return -1;
+	if (size <= zero_class_size(0))
+		return 0;
+	return (64 - __builtin_clzll(size - 1)) - MM_ZERO_CLASS_MIN_LOG2;
+}
+
+static void *alloc_zeroed_block(mm_heap_t *h, uint64_t size) {
+	if (size == 0)
+		return NULL;
+
+	int zc = zero_class_for(size);
+	if (zc >= 0) {
+		void *ptr = NULL;
+		uint64_t flags = irq_save();
+		acquire(&mm_lock);
+		if (h->zero_pool_count[zc] > 0) {
+			ptr = h->zero_pool[zc][--h->zero_pool_count[zc]];
+			uint64_t usable = h->ops->usable_size(ptr);
+			h->cached_bytes -= usable;
+			h->zeroed_bytes -= usable;
+			h->allocation_count++;
+		}
+		release(&mm_lock);
+		irq_restore(flags);
+		if (ptr)
+			return ptr;
+	}
+
+	void *ptr = (size >= MM_PAGE_SIZE) ? alloc_aligned_block(h, size, MM_PAGE_SIZE) : alloc_block(h, size);
+	if (ptr)
+		memset(ptr, 0, size);
+	return ptr;
+}
+
+void *mm_alloc_zeroed(uint64_t size) {
+	void *ptr = alloc_zeroed_block(heap_for_use(MM_USE_GENERAL), size);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+void *mm_alloc_zeroed_for(mm_use_t use, uint64_t size) {
+	void *ptr = alloc_zeroed_block(heap_for_use(use), size);
+	mm_profile_record_alloc(__builtin_return_address(0), ptr, size);
+	return ptr;
+}
+
+/*
+ * Un paso de pre-cerado para el proceso idle: completa la clase con menos bloques del pool de un heap,
+ * rotando entre heaps. El memset corre sin lock y con las interrupciones como las tenga el llamador;
+ * devuelve 0 si no hizo nada.
+ */
+int mm_idle_zero_step(void) {
+	if (!heaps_ready())
+		return 0;
+
+	mm_heap_t *h = NULL;
+	int target = -1;
+	void *ptr = NULL;
+	uint64_t flags = irq_save();
+	acquire(&mm_lock);
+	for (int n = 0; n < heap_count && !ptr; n++) {
+		h = &heaps[(zero_next_heap + n) % heap_count];
+		target = -1;
+		for (int zc = 0; zc < MM_ZERO_CLASS_COUNT; zc++) {
+			if (h->zero_pool_count[zc] < MM_ZERO_POOL_DEPTH &&
+				(target < 0 || h->zero_pool_count[zc] < h->zero_pool_count[target]))
+				target = zc;
+		}
+		if (target >= 0) {
+			mm_stats_t stats;
+			h->ops->get_stats(&stats);
+			if (stats.free_bytes >= MM_ZERO_MIN_FREE)
+				ptr = h->ops->alloc_aligned(zero_class_size(target), MM_PAGE_SIZE);
+		}
+	}
+	zero_next_heap = (zero_next_heap + 1) % heap_count;
+	release(&mm_lock);
+	irq_restore(flags);
+
+	if (!ptr)
+		return 0;
+
+	memset(ptr, 0, zero_class_size(target));
+
+	flags = irq_save();
+	acquire(&mm_lock);
+	if (h->caches_ready && h->zero_pool_count[target] < MM_ZERO_POOL_DEPTH) {
+		uint64_t usable = h->ops->usable_size(ptr);
+		h->zero_pool[target][h->zero_pool_count[target]++] = ptr;
+		h->cached_bytes += usable;
+		h->zeroed_bytes += usable;
+	}
+	else {
+		h->ops->free(ptr);
+	}
+	release(&mm_lock);
+	irq_restore(flags);
+	return 1;
+}
+
+// Un paso del trabajo diferido de los backends (por ejemplo, las uniones perezosas del buddy)
+int mm_idle_trim_step(void) {
+	if (!heaps_ready())
+		return 0;
+
+	int worked = 0;
+	uint64_t flags = irq_save();
+	acquire(&mm_lock);
+	for (int i = 0; i < heap_count; i++) {
+		if (heaps[i].ops->idle_step && heaps[i].ops->idle_step())
+			worked = 1;
+	}
+	release(&mm_lock);
+	irq_restore(flags);
+	return worked;
+}
+
+static void free_block(void *ptr) {
+	if (!ptr || heap_count == 0)
+		return;
+
+	uint64_t flags = irq_save();
+	mm_heap_t *h = heap_of(ptr);
+	uint64_t usable = h->ops->usable_size(ptr);
+	int cls = class_for_free(usable);
+	if (cls < 0 || !h->caches_ready || !cache_push(h, cls, ptr, usable)) {
+		acquire(&mm_lock);
+		h->ops->free(ptr);
+		release(&mm_lock);
+	}
+	h->free_count++;
+	irq_restore(flags);
+}
+
+void mm_free(void *ptr) {
+	mm_profile_record_free(__builtin_return_address(0), ptr);
+	free_block(ptr);
+}
+
+void mm_free_pages(void *ptr) {
+	mm_profile_record_free(__builtin_return_address(0), ptr);
+	free_block(ptr);
+}
+
+// Se llama con interrupciones deshabilitadas
+static void heap_stats(mm_heap_t *h, mm_stats_t *stats) {
+	acquire(&mm_lock);
+	h->ops->get_stats(stats);
+	release(&mm_lock);
+
+	// Los bloques en magazines estan asignados para el backend pero disponibles para el kernel
+	uint64_t cached = (h->cached_bytes < stats->used_bytes) ? h->cached_bytes : stats->used_bytes;
+	stats->used_bytes -= cached;
+	stats->free_bytes += cached;
+	stats->allocations = h->allocation_count;
+	stats->frees = h->free_count;
+	stats->failed_allocations = h->failed_count;
+	stats->zeroed_bytes = h->zeroed_bytes;
+}
+
+void mm_get_stats(mm_stats_t *stats) {
+	if (!stats)
+		return;
+
+	memset(stats, 0, sizeof(mm_stats_t));
+	uint64_t flags = irq_save();
+	for (int i = 0; i < heap_count; i++) {
+		mm_stats_t one;
+		heap_stats(&heaps[i], &one);
+		stats->total_bytes += one.total_bytes;
+		stats->used_bytes += one.used_bytes;
+		stats->free_bytes += one.free_bytes;
+		if (one.largest_free_block > stats->largest_free_block)
+			stats->largest_free_block = one.largest_free_block;
+		stats->allocations += one.allocations;
+		stats->frees += one.frees;
+		stats->failed_allocations += one.failed_allocations;
+		stats->internal_fragmentation += one.internal_fragmentation;
+		stats->zeroed_bytes += one.zeroed_bytes;
+		stats->split_ops += one.split_ops;
+		stats->merge_ops += one.merge_ops;
+	}
+	irq_restore(flags);
+}
+
+uint8_t mm_is_initialized(void) {
+	return heaps_ready();
+}
+
+const char *mm_get_manager_name(void) {
+	return MM_PRIMARY_ALLOCATOR.name;
+}
+
+int mm_heap_count(void) {
+	return heap_count;
+}
+
+const mm_allocator_t *mm_heap_allocator(int heap) {
+	if (heap < 0 || heap >= heap_count)
+		return NULL;
+	return heaps[heap].ops;
+}
+
+uint64_t mm_get_heap_info(mm_heap_info_t *buffer, uint64_t max_count) {
+	if (!buffer)
+		return 0;
+
+	uint64_t count = 0;
+	uint64_t flags = irq_save();
+	for (int i = 0; i < heap_count && count < max_count; i++, count++) {
+		mm_heap_info_t *info = &buffer[count];
+		memset(info, 0, sizeof(mm_heap_info_t));
+		for (int c = 0; c < MM_HEAP_NAME_LEN - 1 && heaps[i].ops->name[c]; c++)
+			info->name[c] = heaps[i].ops->name[c];
+		for (int u = 0; u < MM_USE_COUNT; u++) {
+			if (use_heap[u] == i)
+				info->uses |= 1ULL << u;
+		}
+		heap_stats(&heaps[i], &info->stats);
+	}
+	irq_restore(flags);
+	return count;
+}
+
+int mm_set_use_heap(mm_use_t use, int heap) {
+	if ((unsigned) use >= MM_USE_COUNT || heap < 0 || heap >= heap_count)
+		return 0;
+	use_heap[use] = (uint8_t) heap;
+	return 1;
+}
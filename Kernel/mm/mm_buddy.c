@@ -1,14 +1,9 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
-#include <mm.h>
+#include <mm_backend.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#ifdef USE_BUDDY_MM
-#ifndef MM_DEFAULT_HEAP_LIMIT
-#define MM_DEFAULT_HEAP_LIMIT 0x20000000ULL
-#endif
-
 #define MIN_ALIGN 16ULL
 static inline uint64_t align_up_u64(uint64_t v, uint64_t a) {
 	return (v + a - 1) & ~(a - 1);
@@ -16,34 +11,123 @@ static inline uint64_t align_up_u64(uint64_t v, uint64_t a) {
 static inline uint64_t pow2_u64(uint8_t e) {
 	return 1ULL << e;
 }
+static inline int ffs_u32(uint32_t v) {
+	return v ? __builtin_ctz(v) : -1;
+}
+static inline int fls_u32(uint32_t v) {
+	return v ? 31 - __builtin_clz(v) : -1;
+}
 
 typedef struct buddy_block {
 	struct buddy_block *next;
 	struct buddy_block *prev;
 	uint8_t level;
-	uint8_t is_free;
+	uint8_t arena;
+	uint8_t lazy; // esta en lazy_lists: se libero sin intentar unirlo con su buddy
 } buddy_block_t;
 
-#define HDR_SIZE align_up_u64(sizeof(buddy_block_t), MIN_ALIGN)
-static uint64_t BASE_BLOCK_SIZE = 0;
+// Los bloques asignados no llevan header: el puntero devuelto es el inicio del bloque
+#define BASE_BLOCK_SIZE 32ULL
+#define BASE_BLOCK_LOG2 5
 #define MM_MAX_LEVELS 32
+// Una arena por region del heap
+#define MM_MAX_ARENAS MM_MAX_REGIONS
+#define BUDDY_LARGE_ARENA_MIN (16ULL * 1024 * 1024)
 
 static buddy_block_t *free_lists[MM_MAX_LEVELS];
 
+/*
+ * Buddy perezoso: un bloque liberado no se une con su buddy mientras su nivel tenga menos bloques libres
+ * "locales" que bloques asignados. Esos bloques esperan en lazy_lists, listos para el proximo pedido del mismo
+ * tamaño sin partir ni unir nada. Se unen cuando un pedido no encuentra bloque (presion) o desde el idle, que
+ * devuelve el excedente cuando la demanda del nivel baja. Igual cuentan como libres para el bitmap, asi que un
+ * buddy que se libera normalmente se une con ellos. Con MM_BUDDY_EAGER se une siempre al liberar.
+ */
+static buddy_block_t *lazy_lists[MM_MAX_LEVELS];
+static uint64_t lazy_count[MM_MAX_LEVELS];
+static uint64_t alloc_count[MM_MAX_LEVELS];
+#define LAZY_IDLE_BUDGET 16 // uniones por paso del idle
+
+/*
+ * Cada region de memoria es una arena independiente: los buddies se calculan por offset desde su base y
+ * nunca se unen bloques de arenas distintas. Las listas libres son compartidas por todas las arenas.
+ *
+ * Bitmap de bloques libres por nivel, guardado al inicio de la arena y fuera de los bloques:
+ * el bit (level_bit_offset[l] + offset >> (BASE_BLOCK_LOG2 + l)) vale 1 si ese bloque esta en free_lists[l].
+ *
+ * Tabla lateral con un byte por bloque minimo, indexada por offset: solo el byte del inicio de un bloque
+ * asignado tiene ALLOC_FLAG y su nivel. Si el pedido no llena el bloque lleva TAIL_FLAG y la fragmentacion
+ * interna (en unidades de MIN_ALIGN) va en los bytes de la tabla que siguen, que cubren el resto del bloque
+ * y no se usan mientras esta asignado; en el nivel 0 el flag solo ya alcanza. El bloque queda entero usable.
+ */
+typedef struct {
+	uint8_t *base;
+	uint64_t usable_bytes;
+	uint8_t max_level;
+	uint64_t *free_bitmap;
+	uint64_t level_bit_offset[MM_MAX_LEVELS];
+	uint8_t *block_table;
+} buddy_arena_t;
+
+static buddy_arena_t arenas[MM_MAX_ARENAS];
+static uint8_t arena_count = 0;
+
+// nonempty_levels tiene un bit por nivel con lista no vacia: el mayor bloque libre y el nivel de partida salen con una instruccion
+static uint32_t nonempty_levels = 0;
+
+#define ALLOC_FLAG 0x80
+#define TAIL_FLAG 0x40
+#define LEVEL_MASK 0x1F
+#define WASTE_BYTES 4 // la fragmentacion de un bloque de nivel l entra en l + 1 bits
+
 static uint8_t mm_initialized_flag = 0;
 static uint64_t heap_capacity_bytes = 0;
 static uint64_t heap_used_bytes = 0;
 static uint64_t heap_allocation_count = 0;
 static uint64_t heap_free_count = 0;
 static uint64_t heap_failed_allocations = 0;
+static uint64_t heap_internal_waste = 0;
+static uint64_t split_ops = 0;
+static uint64_t merge_ops = 0;
 
-static void *heap_base = NULL;
-static uint64_t heap_usable_bytes = 0;
+// Mayor nivel entre todas las arenas
 static uint8_t max_level = 0;
 
 static void free_lists_init(void) {
-	for (int i = 0; i < MM_MAX_LEVELS; i++)
+	for (int i = 0; i < MM_MAX_LEVELS; i++) {
 		free_lists[i] = NULL;
+		lazy_lists[i] = NULL;
+		lazy_count[i] = 0;
+		alloc_count[i] = 0;
+	}
+	nonempty_levels = 0;
+}
+
+static inline uint64_t block_bit(const buddy_arena_t *a, const void *b, uint8_t level) {
+	uint64_t offset = (uint64_t) ((const uint8_t *) b - a->base);
+	return a->level_bit_offset[level] + (offset >> (BASE_BLOCK_LOG2 + level));
+}
+
+// Recibe la arena aparte porque b puede ser un bloque asignado, cuyo campo arena no es valido
+static inline int free_bit_test(const buddy_arena_t *a, const void *b, uint8_t level) {
+	uint64_t bit = block_bit(a, b, level);
+	return (a->free_bitmap[bit >> 6] >> (bit & 63)) & 1ULL;
+}
+
+static inline void free_bit_set(const buddy_block_t *b, uint8_t level) {
+	const buddy_arena_t *a = &arenas[b->arena];
+	uint64_t bit = block_bit(a, b, level);
+	a->free_bitmap[bit >> 6] |= (1ULL << (bit & 63));
+}
+
+static inline void free_bit_clear(const buddy_block_t *b, uint8_t level) {
+	const buddy_arena_t *a = &arenas[b->arena];
+	uint64_t bit = block_bit(a, b, level);
+	a->free_bitmap[bit >> 6] &= ~(1ULL << (bit & 63));
+}
+
+static inline uint64_t level_size(uint8_t level) {
+	return pow2_u64(level) * BASE_BLOCK_SIZE;
 }
 
 static uint8_t order_for(uint64_t size_bytes) {
@@ -57,261 +141,425 @@ static uint8_t order_for(uint64_t size_bytes) {
 	return order;
 }
 
-static void push_free(buddy_block_t *b) {
-	b->is_free = 1;
+static void push_to(buddy_block_t **lists, buddy_block_t *b) {
 	b->prev = NULL;
-	b->next = free_lists[b->level];
+	b->next = lists[b->level];
 	if (b->next)
 		b->next->prev = b;
-	free_lists[b->level] = b;
+	lists[b->level] = b;
+	free_bit_set(b, b->level);
+	nonempty_levels |= (1U << b->level);
+}
+
+static void push_free(buddy_block_t *b) {
+	b->lazy = 0;
+	push_to(free_lists, b);
 }
 
+#ifndef MM_BUDDY_EAGER
+static void push_lazy(buddy_block_t *b) {
+	b->lazy = 1;
+	lazy_count[b->level]++;
+	push_to(lazy_lists, b);
+}
+#endif
+
+static void remove_from_free_list(buddy_block_t *b) {
+	buddy_block_t **lists = b->lazy ? lazy_lists : free_lists;
+	if (b->prev)
+		b->prev->next = b->next;
+	else
+		lists[b->level] = b->next;
+	if (b->next)
+		b->next->prev = b->prev;
+	b->next = b->prev = NULL;
+	if (b->lazy) {
+		lazy_count[b->level]--;
+		b->lazy = 0;
+	}
+	free_bit_clear(b, b->level);
+	if (!free_lists[b->level] && !lazy_lists[b->level])
+		nonempty_levels &= ~(1U << b->level);
+}
+
+// Prefiere los bloques perezosos: son los que se liberaron hace poco y ya tienen el tamaño justo
 static buddy_block_t *pop_free(uint8_t level) {
-	buddy_block_t *b = free_lists[level];
+	buddy_block_t *b = lazy_lists[level] ? lazy_lists[level] : free_lists[level];
 	if (!b)
 		return NULL;
-	free_lists[level] = b->next;
-	if (free_lists[level])
-		free_lists[level]->prev = NULL;
-	b->next = b->prev = NULL;
-	b->is_free = 0;
+	remove_from_free_list(b);
 	return b;
 }
 
-static buddy_block_t *split_down(uint8_t from_level, uint8_t to_level) {
-	for (uint8_t l = from_level; l > to_level; l--) {
-		buddy_block_t *blk = pop_free(l);
-		if (!blk)
-			return NULL;
-		uint64_t size = pow2_u64(l) * BASE_BLOCK_SIZE;
+// Parte un bloque ya sacado de su lista hasta to_level; cada nivel intermedio deja su mitad superior libre
+static void split_block(buddy_block_t *blk, uint8_t to_level) {
+	for (uint8_t l = blk->level; l > to_level; l--) {
+		uint64_t size = level_size(l);
 
 		buddy_block_t *buddy = (buddy_block_t *) ((uint8_t *) blk + (size >> 1));
 		buddy->level = l - 1;
-		buddy->is_free = 1;
-		buddy->next = buddy->prev = NULL;
+		buddy->arena = blk->arena;
 		push_free(buddy);
 
 		blk->level = l - 1;
-		blk->is_free = 1;
-		blk->next = blk->prev = NULL;
-		push_free(blk);
+		split_ops++;
 	}
-	return pop_free(to_level);
 }
 
-static buddy_block_t *get_block_from_ptr(void *ptr) {
-	if (!ptr)
-		return NULL;
-	return (buddy_block_t *) ((uint8_t *) ptr - HDR_SIZE);
+static buddy_block_t *split_down(uint8_t from_level, uint8_t to_level) {
+	buddy_block_t *blk = pop_free(from_level);
+	if (blk)
+		split_block(blk, to_level);
+	return blk;
+}
+
+// Arena que contiene a ptr como inicio de un bloque minimo, o -1 si no pertenece al heap
+static int arena_for(const void *ptr) {
+	for (int i = 0; i < arena_count; i++) {
+		const buddy_arena_t *a = &arenas[i];
+		if ((const uint8_t *) ptr < a->base)
+			continue;
+		uint64_t offset = (uint64_t) ((const uint8_t *) ptr - a->base);
+		if (offset < a->usable_bytes)
+			return (offset & (BASE_BLOCK_SIZE - 1)) ? -1 : i;
+	}
+	return -1;
+}
+
+static inline uint8_t *table_entry(const buddy_arena_t *a, const void *blk) {
+	return &a->block_table[(uint64_t) ((const uint8_t *) blk - a->base) >> BASE_BLOCK_LOG2];
 }
 
 static buddy_block_t *find_buddy(buddy_block_t *blk) {
-	uint64_t offset = (uint64_t) ((uint8_t *) blk - (uint8_t *) heap_base);
-	uint64_t block_size = pow2_u64(blk->level) * BASE_BLOCK_SIZE;
+	const buddy_arena_t *a = &arenas[blk->arena];
+	uint64_t offset = (uint64_t) ((uint8_t *) blk - a->base);
+	uint64_t block_size = level_size(blk->level);
 	uint64_t buddy_off = offset ^ block_size;
 
-	if (buddy_off + block_size > heap_usable_bytes)
+	if (buddy_off + block_size > a->usable_bytes)
 		return NULL;
 
-	return (buddy_block_t *) ((uint8_t *) heap_base + buddy_off);
-}
-
-static void remove_from_free_list(buddy_block_t *b) {
-	buddy_block_t **head = &free_lists[b->level];
-	while (*head && *head != b)
-		head = &((*head)->next);
-	if (*head == b) {
-		*head = b->next;
-		if (b->next)
-			b->next->prev = b->prev;
-		b->next = b->prev = NULL;
-	}
+	return (buddy_block_t *) (a->base + buddy_off);
 }
 
 static void coalesce(buddy_block_t *blk) {
-	while (blk->level < max_level) {
+	uint8_t arena_max = arenas[blk->arena].max_level;
+	while (blk->level < arena_max) {
 		buddy_block_t *bud = find_buddy(blk);
-		if (!bud || !bud->is_free || bud->level != blk->level)
+		if (!bud || !free_bit_test(&arenas[blk->arena], bud, blk->level))
 			break;
 
 		remove_from_free_list(bud);
 
 		if (bud < blk)
 			blk = bud;
-
 		blk->level++;
-		blk->is_free = 1;
+		merge_ops++;
 	}
 	push_free(blk);
 }
 
-
-void mm_init(void *heap_start, uint64_t heap_size) {
-	const uint64_t min_need_init = HDR_SIZE + 16ULL;
-	if (heap_size < min_need_init) {
-		mm_initialized_flag = 0;
-		heap_capacity_bytes = 0;
-		heap_usable_bytes = 0;
-		return;
+// Une hasta budget bloques perezosos; con only_surplus solo los que exceden la demanda de su nivel
+static int merge_lazy(int budget, int only_surplus) {
+	int merged = 0;
+	for (uint8_t l = 0; l <= max_level && merged < budget; l++) {
+		while (lazy_lists[l] && merged < budget && (!only_surplus || lazy_count[l] > alloc_count[l])) {
+			buddy_block_t *b = lazy_lists[l];
+			remove_from_free_list(b);
+			coalesce(b);
+			merged++;
+		}
 	}
+	return merged;
+}
 
-	uint64_t aligned_start = align_up_u64((uint64_t) heap_start, MIN_ALIGN);
-	uint64_t alignment_loss = aligned_start - (uint64_t) heap_start;
-	if (alignment_loss >= heap_size) {
-		mm_initialized_flag = 0;
-		heap_capacity_bytes = 0;
-		heap_usable_bytes = 0;
-		return;
-	}
+static uint64_t lazy_total(void) {
+	uint64_t total = 0;
+	for (uint8_t l = 0; l <= max_level; l++)
+		total += lazy_count[l];
+	return total;
+}
 
-	uint64_t usable = heap_size - alignment_loss;
-	usable &= ~(MIN_ALIGN - 1ULL);
-	if (usable < min_need_init) {
-		mm_initialized_flag = 0;
-		heap_capacity_bytes = 0;
-		heap_usable_bytes = 0;
+static uint64_t bitmap_bytes_for(uint64_t usable, uint8_t levels) {
+	uint64_t bits = 0;
+	for (uint8_t l = 0; l <= levels; l++)
+		bits += usable >> (BASE_BLOCK_LOG2 + l);
+	return align_up_u64((bits + 63) / 64 * sizeof(uint64_t), MIN_ALIGN);
+}
+
+static uint64_t table_bytes_for(uint64_t usable) {
+	return align_up_u64(usable >> BASE_BLOCK_LOG2, MIN_ALIGN);
+}
+
+static void buddy_add_region(void *start, uint64_t size) {
+	if (arena_count >= MM_MAX_ARENAS || size < BASE_BLOCK_SIZE)
 		return;
-	}
 
-	heap_base = (void *) aligned_start;
-	heap_usable_bytes = usable;
+	uint64_t aligned_start = align_up_u64((uint64_t) start, MIN_ALIGN);
+	uint64_t alignment_loss = aligned_start - (uint64_t) start;
+	if (alignment_loss >= size)
+		return;
 
-	uint64_t min_need = HDR_SIZE + 16ULL;
-	uint64_t v = 1;
-	while (v < min_need)
-		v <<= 1;
-	BASE_BLOCK_SIZE = v;
+	uint64_t usable = size - alignment_loss;
+	usable &= ~(MIN_ALIGN - 1ULL);
 
-	max_level = 0;
+	uint8_t levels = 0;
 	uint64_t sz = BASE_BLOCK_SIZE;
-	while (sz < usable && max_level < (MM_MAX_LEVELS - 1)) {
+	while (sz < usable && levels < (MM_MAX_LEVELS - 1)) {
 		sz <<= 1;
-		max_level++;
+		levels++;
 	}
 
-	free_lists_init();
+	// La metadata se dimensiona con el tamaño total, que acota al que queda luego de reservarla
+	uint64_t bitmap_bytes = bitmap_bytes_for(usable, levels);
+	uint64_t metadata = bitmap_bytes + table_bytes_for(usable);
+	// Base alineada a 2 MB (o a pagina en regiones chicas) para que los bloques grandes sirvan a mm_alloc_aligned
+	uint64_t base_align = (usable >= BUDDY_LARGE_ARENA_MIN) ? MM_LARGE_PAGE_SIZE : MM_PAGE_SIZE;
+	uint64_t base = align_up_u64(aligned_start + metadata, base_align);
+	if (base + BASE_BLOCK_SIZE > aligned_start + usable)
+		return;
 
-	uint64_t remaining = usable;
-	uint8_t *cur = (uint8_t *) heap_base;
+	uint8_t idx = arena_count;
+	buddy_arena_t *a = &arenas[idx];
+	a->free_bitmap = (uint64_t *) aligned_start;
+	for (uint64_t i = 0; i < metadata / sizeof(uint64_t); i++)
+		a->free_bitmap[i] = 0;
+	a->block_table = (uint8_t *) aligned_start + bitmap_bytes;
+	a->base = (uint8_t *) base;
+	a->usable_bytes = aligned_start + usable - base;
+	a->max_level = levels;
+
+	uint64_t bit_offset = 0;
+	for (uint8_t l = 0; l < MM_MAX_LEVELS; l++) {
+		a->level_bit_offset[l] = bit_offset;
+		if (l <= levels)
+			bit_offset += a->usable_bytes >> (BASE_BLOCK_LOG2 + l);
+	}
+	arena_count++;
+
+	uint64_t remaining = a->usable_bytes;
+	uint8_t *cur = a->base;
 	while (remaining >= BASE_BLOCK_SIZE) {
-		int l = max_level;
-		while (l > 0 && pow2_u64(l) * BASE_BLOCK_SIZE > remaining)
+		int l = levels;
+		while (l > 0 && level_size(l) > remaining)
 			l--;
-		uint64_t blk_size = pow2_u64(l) * BASE_BLOCK_SIZE;
+		uint64_t blk_size = level_size(l);
 		buddy_block_t *b = (buddy_block_t *) cur;
-		b->next = b->prev = NULL;
 		b->level = (uint8_t) l;
-		b->is_free = 1;
+		b->arena = idx;
 		push_free(b);
 		cur += blk_size;
 		remaining -= blk_size;
 	}
 
-	heap_capacity_bytes = usable - HDR_SIZE;
+	if (levels > max_level)
+		max_level = levels;
+	heap_capacity_bytes += a->usable_bytes;
+	mm_initialized_flag = 1;
+}
+
+static void buddy_init(void *heap_start, uint64_t heap_size) {
+	mm_initialized_flag = 0;
+	arena_count = 0;
+	max_level = 0;
+	free_lists_init();
+
+	heap_capacity_bytes = 0;
 	heap_used_bytes = 0;
 	heap_allocation_count = 0;
 	heap_free_count = 0;
 	heap_failed_allocations = 0;
+	heap_internal_waste = 0;
+	split_ops = 0;
+	merge_ops = 0;
 
-	mm_initialized_flag = 1;
+	buddy_add_region(heap_start, heap_size);
 }
 
-static void mm_default_region(void **start, uint64_t *size) {
-	extern uint8_t endOfKernel;
-	const uint64_t MM_PAGE_SIZE = 0x1000ULL;
-	const uint64_t MM_KERNEL_STACK_PAGES = 8ULL;
-
-	const uint64_t raw_start = (uint64_t) &endOfKernel + MM_PAGE_SIZE * MM_KERNEL_STACK_PAGES;
-	const uint64_t aligned_start = align_up_u64(raw_start, MIN_ALIGN);
-	const uint64_t heap_limit = MM_DEFAULT_HEAP_LIMIT;
+static inline uint64_t waste_bytes_for(uint8_t level) {
+	uint64_t extra = (1ULL << level) - 1;
+	return extra < WASTE_BYTES ? extra : WASTE_BYTES;
+}
 
-	if (aligned_start >= heap_limit) {
-		*start = NULL;
-		*size = 0;
+static void waste_store(uint8_t *entry, uint8_t level, uint64_t waste) {
+	if (waste == 0)
 		return;
-	}
-	*start = (void *) aligned_start;
-	*size = heap_limit - aligned_start;
+	*entry |= TAIL_FLAG;
+	uint64_t units = waste / MIN_ALIGN;
+	for (uint64_t i = 0; i < waste_bytes_for(level); i++)
+		entry[1 + i] = (uint8_t) (units >> (8 * i));
 }
 
-void mm_init_default(void) {
-	void *start = NULL;
-	uint64_t size = 0;
-	mm_default_region(&start, &size);
-	if (start && size)
-		mm_init(start, size);
+static uint64_t waste_load(const uint8_t *entry, uint8_t level) {
+	if (!(*entry & TAIL_FLAG))
+		return 0;
+	if (level == 0)
+		return MIN_ALIGN;
+	uint64_t units = 0;
+	for (uint64_t i = 0; i < waste_bytes_for(level); i++)
+		units |= (uint64_t) entry[1 + i] << (8 * i);
+	return units * MIN_ALIGN;
 }
 
-void *mm_alloc(uint64_t size) {
+// Marca blk (ya partido a nivel ord) como asignado para un pedido de req bytes
+static void *take_block(buddy_block_t *blk, uint8_t ord, uint64_t req) {
+	uint64_t block_size = level_size(ord);
+	uint8_t *entry = table_entry(&arenas[blk->arena], blk);
+	*entry = ALLOC_FLAG | ord;
+	if (req < block_size) {
+		waste_store(entry, ord, block_size - req);
+		heap_internal_waste += block_size - req;
+	}
+
+	heap_used_bytes += block_size;
+	if (heap_used_bytes > heap_capacity_bytes)
+		heap_used_bytes = heap_capacity_bytes;
+	heap_allocation_count++;
+	alloc_count[ord]++;
+
+	return blk;
+}
+
+static void *buddy_alloc(uint64_t size) {
 	if (!mm_initialized_flag) {
-		mm_init_default();
-		if (!mm_initialized_flag) {
-			heap_failed_allocations++;
-			return NULL;
-		}
+		heap_failed_allocations++;
+		return NULL;
 	}
 	if (size == 0)
 		return NULL;
 
 	uint64_t req = align_up_u64(size, MIN_ALIGN);
-	uint8_t ord = order_for(req + HDR_SIZE);
-
-	buddy_block_t *blk = pop_free(ord);
-	if (!blk) {
-		for (uint8_t l = ord + 1; l <= max_level; l++) {
-			if (free_lists[l]) {
-				blk = split_down(l, ord);
-				break;
-			}
-		}
+	uint8_t ord = order_for(req);
+
+	buddy_block_t *blk = NULL;
+	int from = (ord <= max_level) ? ffs_u32(nonempty_levels & (~0U << ord)) : -1;
+	// Sin bloque del tamaño: bajo presion se unen todos los perezosos y se reintenta
+	if (from < 0 && ord <= max_level && lazy_total() > 0) {
+		merge_lazy(INT32_MAX, 0);
+		from = ffs_u32(nonempty_levels & (~0U << ord));
 	}
+	if (from >= 0)
+		blk = split_down((uint8_t) from, ord);
 	if (!blk) {
 		heap_failed_allocations++;
 		return NULL;
 	}
+	return take_block(blk, ord, req);
+}
 
-	blk->is_free = 0;
+static buddy_block_t *find_aligned(uint8_t ord, uint64_t align) {
+	for (uint8_t l = ord; l <= max_level; l++) {
+		if (!(nonempty_levels & (1U << l)))
+			continue;
+		for (int lazy = 1; lazy >= 0; lazy--) {
+			for (buddy_block_t *b = lazy ? lazy_lists[l] : free_lists[l]; b; b = b->next) {
+				if (((uint64_t) b & (align - 1)) == 0)
+					return b;
+			}
+		}
+	}
+	return NULL;
+}
 
-	uint64_t payload = pow2_u64(ord) * BASE_BLOCK_SIZE - HDR_SIZE;
-	heap_used_bytes += payload;
-	if (heap_used_bytes > heap_capacity_bytes)
-		heap_used_bytes = heap_capacity_bytes;
+/*
+ * Un bloque de nivel ord queda alineado a su propio tamaño respecto de la base de la arena, asi que basta con
+ * pedir un nivel >= align y que el bloque elegido caiga en una direccion alineada: no se pierde un bloque extra.
+ */
+static void *buddy_alloc_aligned(uint64_t size, uint64_t align) {
+	if (align <= MIN_ALIGN)
+		return buddy_alloc(size);
+	if (!mm_initialized_flag) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+	if (size == 0 || (align & (align - 1)))
+		return NULL;
 
-	return (uint8_t *) blk + HDR_SIZE;
+	uint64_t req = align_up_u64(size, MIN_ALIGN);
+	uint8_t ord = order_for(req > align ? req : align);
+	buddy_block_t *b = find_aligned(ord, align);
+	if (!b && lazy_total() > 0) {
+		merge_lazy(INT32_MAX, 0);
+		b = find_aligned(ord, align);
+	}
+	if (!b) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+	remove_from_free_list(b);
+	split_block(b, ord);
+	return take_block(b, ord, req);
 }
 
-void mm_free(void *ptr) {
+static void buddy_free(void *ptr) {
 	if (!ptr || !mm_initialized_flag)
 		return;
 
-	buddy_block_t *blk = get_block_from_ptr(ptr);
-	if (!blk || blk->is_free)
+	int arena = arena_for(ptr);
+	if (arena < 0)
 		return;
 
-	blk->is_free = 1;
+	uint8_t *entry = table_entry(&arenas[arena], ptr);
+	if (!(*entry & ALLOC_FLAG))
+		return;
+
+	buddy_block_t *blk = (buddy_block_t *) ptr;
+	uint8_t level = *entry & LEVEL_MASK;
+	uint64_t block_size = level_size(level);
+
+	uint64_t waste = waste_load(entry, level);
+	heap_internal_waste = (heap_internal_waste >= waste) ? heap_internal_waste - waste : 0;
+	// Los bytes de la fragmentacion son los inicios de los bloques en que se parta despues
+	for (uint64_t i = 0; i <= waste_bytes_for(level); i++)
+		entry[i] = 0;
+
 	heap_free_count++;
 
-	uint64_t payload = pow2_u64(blk->level) * BASE_BLOCK_SIZE - HDR_SIZE;
-	if (heap_used_bytes >= payload)
-		heap_used_bytes -= payload;
+	if (heap_used_bytes >= block_size)
+		heap_used_bytes -= block_size;
 	else
 		heap_used_bytes = 0;
 
+	blk->level = level;
+	blk->arena = (uint8_t) arena;
+	alloc_count[level]--;
+#ifdef MM_BUDDY_EAGER
 	coalesce(blk);
+#else
+	if (lazy_count[level] < alloc_count[level])
+		push_lazy(blk);
+	else
+		coalesce(blk);
+#endif
+}
+
+// Desde el idle: une los perezosos que sobran para la demanda actual de su nivel
+static int buddy_idle_step(void) {
+	if (!mm_initialized_flag)
+		return 0;
+	return merge_lazy(LAZY_IDLE_BUDGET, 1) > 0;
 }
 
-void mm_get_stats(mm_stats_t *s) {
+static uint64_t buddy_usable_size(void *ptr) {
+	if (!ptr || !mm_initialized_flag)
+		return 0;
+
+	int arena = arena_for(ptr);
+	if (arena < 0)
+		return 0;
+
+	uint8_t entry = *table_entry(&arenas[arena], ptr);
+	if (!(entry & ALLOC_FLAG))
+		return 0;
+	return level_size(entry & LEVEL_MASK);
+}
+
+static void buddy_get_stats(mm_stats_t *s) {
 	if (!s)
 		return;
 
-	uint64_t largest = 0;
-	for (uint8_t l = 0; l <= max_level; l++) {
-		for (buddy_block_t *cur = free_lists[l]; cur; cur = cur->next) {
-			uint64_t cur_payload = pow2_u64(cur->level) * BASE_BLOCK_SIZE - HDR_SIZE;
-			if (cur_payload > largest)
-				largest = cur_payload;
-		}
-	}
+	int top = fls_u32(nonempty_levels);
+	uint64_t largest = (top >= 0) ? level_size((uint8_t) top) : 0;
 
 	s->total_bytes = heap_capacity_bytes;
 	s->used_bytes = heap_used_bytes;
@@ -320,14 +568,24 @@ void mm_get_stats(mm_stats_t *s) {
 	s->allocations = heap_allocation_count;
 	s->frees = heap_free_count;
 	s->failed_allocations = heap_failed_allocations;
+	s->internal_fragmentation = heap_internal_waste;
+	s->split_ops = split_ops;
+	s->merge_ops = merge_ops;
 }
 
-uint8_t mm_is_initialized(void) {
+static uint8_t buddy_is_initialized(void) {
 	return mm_initialized_flag;
 }
 
-const char *mm_get_manager_name(void) {
-	return "buddy";
-}
-
-#endif
+const mm_allocator_t mm_buddy_allocator = {
+	.name = "buddy",
+	.init = buddy_init,
+	.add_region = buddy_add_region,
+	.alloc = buddy_alloc,
+	.alloc_aligned = buddy_alloc_aligned,
+	.free = buddy_free,
+	.usable_size = buddy_usable_size,
+	.get_stats = buddy_get_stats,
+	.is_initialized = buddy_is_initialized,
+	.idle_step = buddy_idle_step,
+};
@@ -0,0 +1,226 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <lib.h>
+#include <mm_profile.h>
+#include <scheduler.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Todo es estatico para que el profiler nunca pida memoria al mm que esta midiendo.
+ * Los sitios se buscan por hash (caller, pid) y no se borran hasta volver a encender;
+ * los bloques vivos van en una tabla con sondeo lineal que al borrar corre los siguientes hacia atras.
+ */
+#define SITE_HASH_SIZE (2 * MM_PROF_MAX_SITES)
+#define NO_SITE 0xFFFF
+
+typedef struct {
+	uint64_t ptr;
+	uint64_t size;
+	uint16_t site;
+} live_block_t;
+
+static uint8_t profile_enabled = 0;
+static mm_prof_event_t ring[MM_PROF_RING_SIZE];
+static uint64_t event_count = 0;
+static mm_prof_site_t sites[MM_PROF_MAX_SITES];
+static uint16_t site_hash[SITE_HASH_SIZE];
+static uint64_t site_count = 0;
+static live_block_t live[MM_PROF_MAX_LIVE];
+static uint64_t untracked = 0;
+
+static inline uint64_t hash64(uint64_t value) {
+	return value * 0x9E3779B97F4A7C15ULL;
+}
+
+static inline uint64_t live_slot(uint64_t ptr) {
+	return (hash64(ptr >> 4) >> 32) & (MM_PROF_MAX_LIVE - 1);
+}
+
+static uint64_t current_pid(void) {
+	process_t *p = scheduler_current_process();
+	return p ? p->pid : 0;
+}
+
+static void push_event(uint64_t caller, uint64_t ptr, uint64_t size, uint64_t pid, uint64_t is_free) {
+	mm_prof_event_t *ev = &ring[event_count % MM_PROF_RING_SIZE];
+	ev->caller = caller;
+	ev->ptr = ptr;
+	ev->size = size;
+	ev->pid = pid;
+	ev->ticks = (uint64_t) ticks_elapsed();
+	ev->is_free = is_free;
+	event_count++;
+}
+
+// Indice del sitio (caller, pid), creandolo si hace falta; NO_SITE si la tabla esta llena
+static uint16_t find_site(uint64_t caller, uint64_t pid) {
+	uint64_t h = (hash64(caller ^ (pid << 48)) >> 32) % SITE_HASH_SIZE;
+	for (uint64_t i = 0; i < SITE_HASH_SIZE; i++) {
+		uint64_t slot = (h + i) % SITE_HASH_SIZE;
+		uint16_t idx = site_hash[slot];
+		if (idx == NO_SITE) {
+			if (site_count == MM_PROF_MAX_SITES)
+				return NO_SITE;
+			idx = (uint16_t) site_count++;
+			memset(&sites[idx], 0, sizeof(mm_prof_site_t));
+			sites[idx].caller = caller;
+			sites[idx].pid = pid;
+			site_hash[slot] = idx;
+			return idx;
+		}
+		if (sites[idx].caller == caller && sites[idx].pid == pid)
+			return idx;
+	}
+	return NO_SITE;
+}
+
+static int live_insert(uint64_t ptr, uint64_t size, uint16_t site) {
+	uint64_t slot = live_slot(ptr);
+	for (uint64_t i = 0; i < MM_PROF_MAX_LIVE; i++) {
+		live_block_t *b = &live[(slot + i) & (MM_PROF_MAX_LIVE - 1)];
+		if (b->ptr == 0 || b->ptr == ptr) {
+			b->ptr = ptr;
+			b->size = size;
+			b->site = site;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int live_remove(uint64_t ptr, live_block_t *out) {
+	uint64_t slot = live_slot(ptr);
+	uint64_t i;
+	for (i = 0; i < MM_PROF_MAX_LIVE; i++) {
+		uint64_t pos = (slot + i) & (MM_PROF_MAX_LIVE - 1);
+		if (live[pos].ptr == 0)
+			return 0;
+		if (live[pos].ptr == ptr) {
+			slot = pos;
+			break;
+		}
+	}
+	if (i == MM_PROF_MAX_LIVE)
+		return 0;
+
+	*out = live[slot];
+	// Corrimiento hacia atras: las entradas siguientes que ya no se encontrarian pasan al hueco
+	uint64_t hole = slot;
+	uint64_t next = (hole + 1) & (MM_PROF_MAX_LIVE - 1);
+	while (live[next].ptr != 0) {
+		uint64_t home = live_slot(live[next].ptr);
+		if (((next - home) & (MM_PROF_MAX_LIVE - 1)) >= ((next - hole) & (MM_PROF_MAX_LIVE - 1))) {
+			live[hole] = live[next];
+			hole = next;
+		}
+		next = (next + 1) & (MM_PROF_MAX_LIVE - 1);
+	}
+	live[hole].ptr = 0;
+	return 1;
+}
+
+void mm_profile_enable(void) {
+	uint64_t flags = irq_save();
+	memset(ring, 0, sizeof(ring));
+	memset(live, 0, sizeof(live));
+	for (int i = 0; i < SITE_HASH_SIZE; i++)
+		site_hash[i] = NO_SITE;
+	event_count = 0;
+	site_count = 0;
+	untracked = 0;
+	profile_enabled = 1;
+	irq_restore(flags);
+}
+
+void mm_profile_disable(void) {
+	profile_enabled = 0;
+}
+
+void mm_profile_record_alloc(void *caller, void *ptr, uint64_t size) {
+	if (!profile_enabled)
+		return;
+
+	uint64_t flags = irq_save();
+	uint64_t pid = current_pid();
+	push_event((uint64_t) caller, (uint64_t) ptr, size, pid, 0);
+	if (ptr) {
+		uint16_t idx = find_site((uint64_t) caller, pid);
+		if (idx == NO_SITE || !live_insert((uint64_t) ptr, size, idx)) {
+			untracked++;
+		}
+		else {
+			mm_prof_site_t *site = &sites[idx];
+			site->allocations++;
+			site->live_blocks++;
+			site->live_bytes += size;
+			if (site->live_bytes > site->peak_bytes)
+				site->peak_bytes = site->live_bytes;
+		}
+	}
+	irq_restore(flags);
+}
+
+void mm_profile_record_free(void *caller, void *ptr) {
+	if (!profile_enabled || !ptr)
+		return;
+
+	uint64_t flags = irq_save();
+	live_block_t block;
+	uint64_t size = 0;
+	// Los bytes se descuentan del sitio que pidio el bloque, no del que lo libera
+	if (live_remove((uint64_t) ptr, &block)) {
+		mm_prof_site_t *site = &sites[block.site];
+		site->frees++;
+		site->live_blocks--;
+		site->live_bytes -= block.size;
+		size = block.size;
+	}
+	push_event((uint64_t) caller, (uint64_t) ptr, size, current_pid(), 1);
+	irq_restore(flags);
+}
+
+void mm_profile_status(mm_prof_status_t *status) {
+	if (!status)
+		return;
+	uint64_t flags = irq_save();
+	status->enabled = profile_enabled;
+	status->events = event_count;
+	status->sites = site_count;
+	status->untracked = untracked;
+	irq_restore(flags);
+}
+
+uint64_t mm_profile_top_sites(mm_prof_site_t *buffer, uint64_t max_count) {
+	if (!buffer || max_count == 0)
+		return 0;
+
+	uint64_t flags = irq_save();
+	uint8_t taken[MM_PROF_MAX_SITES] = {0};
+	uint64_t count = 0;
+	while (count < max_count && count < site_count) {
+		int best = -1;
+		for (uint64_t i = 0; i < site_count; i++) {
+			if (!taken[i] && (best < 0 || sites[i].live_bytes > sites[best].live_bytes))
+				best = (int) i;
+		}
+		taken[best] = 1;
+		buffer[count++] = sites[best];
+	}
+	irq_restore(flags);
+	return count;
+}
+
+uint64_t mm_profile_recent_events(mm_prof_event_t *buffer, uint64_t max_count) {
+	if (!buffer || max_count == 0)
+		return 0;
+
+	uint64_t flags = irq_save();
+	uint64_t available = (event_count < MM_PROF_RING_SIZE) ? event_count : MM_PROF_RING_SIZE;
+	uint64_t count = (max_count < available) ? max_count : available;
+	for (uint64_t i = 0; i < count; i++)
+		buffer[i] = ring[(event_count - 1 - i) % MM_PROF_RING_SIZE];
+	irq_restore(flags);
+	return count;
+}
@@ -1,19 +1,12 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
-#include <mm.h>
+#include <mm_backend.h>
 #include <stdint.h>
 
-#ifdef USE_SIMPLE_MM
-
-#ifndef MM_DEFAULT_HEAP_LIMIT
-#define MM_DEFAULT_HEAP_LIMIT 0x20000000ULL
-#endif
-
-#define MM_PAGE_SIZE 0x1000ULL
-#define MM_KERNEL_STACK_PAGES 8ULL
 #define MM_ALIGNMENT 16ULL
 
 #define BLOCK_ALLOCATED_FLAG 1ULL
+#define MM_BIN_COUNT 64
 
 typedef struct block_header block_header_t;
 
@@ -25,7 +18,15 @@ struct block_header {
 	block_header_t *next_free;
 };
 
-static block_header_t free_list_sentinel;
+// Header redondeado a MM_ALIGNMENT para que el payload quede alineado a 16
+#define BLOCK_HEADER_SIZE align_up(sizeof(block_header_t), MM_ALIGNMENT)
+
+/*
+ * Bins por potencia de 2: el bin i guarda los bloques libres con tamaño en [2^i, 2^(i+1)).
+ * nonempty_bins tiene un bit por bin con bloques, asi la busqueda salta directo al primer bin util.
+ */
+static block_header_t bin_sentinels[MM_BIN_COUNT];
+static uint64_t nonempty_bins = 0;
 static uint8_t mm_initialized_flag = 0;
 static uint64_t heap_capacity_bytes = 0;
 static uint64_t heap_used_bytes = 0;
@@ -56,39 +57,78 @@ static inline void block_mark_free(block_header_t *block) {
 	block->size_and_flags &= ~BLOCK_ALLOCATED_FLAG;
 }
 
+static inline int bin_for(uint64_t size) {
+	return 63 - __builtin_clzll(size);
+}
+
+static inline int bin_is_empty(int bin) {
+	return bin_sentinels[bin].next_free == &bin_sentinels[bin];
+}
+
 static void free_list_init(void) {
-	free_list_sentinel.prev_free = &free_list_sentinel;
-	free_list_sentinel.next_free = &free_list_sentinel;
+	for (int i = 0; i < MM_BIN_COUNT; i++) {
+		bin_sentinels[i].prev_free = &bin_sentinels[i];
+		bin_sentinels[i].next_free = &bin_sentinels[i];
+	}
+	nonempty_bins = 0;
 }
 
 static void free_list_insert(block_header_t *block) {
-	block->prev_free = &free_list_sentinel;
-	block->next_free = free_list_sentinel.next_free;
-	free_list_sentinel.next_free->prev_free = block;
-	free_list_sentinel.next_free = block;
+	int bin = bin_for(block_size(block));
+	block_header_t *sentinel = &bin_sentinels[bin];
+	block->prev_free = sentinel;
+	block->next_free = sentinel->next_free;
+	sentinel->next_free->prev_free = block;
+	sentinel->next_free = block;
+	nonempty_bins |= (1ULL << bin);
 }
 
 static void free_list_remove(block_header_t *block) {
+	int bin = bin_for(block_size(block));
 	block->prev_free->next_free = block->next_free;
 	block->next_free->prev_free = block->prev_free;
 	block->prev_free = NULL;
 	block->next_free = NULL;
+	if (bin_is_empty(bin)) {
+		nonempty_bins &= ~(1ULL << bin);
+	}
 }
 
-static block_header_t *find_first_fit(uint64_t required_size) {
-	for (block_header_t *current = free_list_sentinel.next_free; current != &free_list_sentinel;
+static block_header_t *find_best_fit_in_bin(int bin, uint64_t required_size) {
+	block_header_t *best = NULL;
+	for (block_header_t *current = bin_sentinels[bin].next_free; current != &bin_sentinels[bin];
 		 current = current->next_free) {
 		uint64_t current_size = block_size(current);
-		if (current_size >= required_size) {
-			return current;
+		if (current_size >= required_size && (best == NULL || current_size < block_size(best))) {
+			best = current;
+			if (current_size == required_size) {
+				break;
+			}
+		}
+	}
+	return best;
+}
+
+// Best-fit dentro del bin del pedido; si no alcanza, cualquier bloque de un bin mayor sirve y se toma el primero
+static block_header_t *find_fit(uint64_t required_size) {
+	int bin = bin_for(required_size);
+	if (nonempty_bins & (1ULL << bin)) {
+		block_header_t *block = find_best_fit_in_bin(bin, required_size);
+		if (block != NULL) {
+			return block;
 		}
 	}
-	return NULL;
+
+	uint64_t larger = (bin + 1 < MM_BIN_COUNT) ? (nonempty_bins & (~0ULL << (bin + 1))) : 0;
+	if (larger == 0) {
+		return NULL;
+	}
+	return bin_sentinels[__builtin_ctzll(larger)].next_free;
 }
 
 static block_header_t *split_block_if_possible(block_header_t *block, uint64_t required_size) {
 	const uint64_t total_size = block_size(block);
-	const uint64_t header_size = sizeof(block_header_t);
+	const uint64_t header_size = BLOCK_HEADER_SIZE;
 	const uint64_t min_block_size = header_size + MM_ALIGNMENT;
 
 	if (total_size < required_size + min_block_size) {
@@ -142,46 +182,25 @@ static block_header_t *coalesce_with_neighbors(block_header_t *block) {
 	return block;
 }
 
-void mm_init(void *heap_start, uint64_t heap_size) {
-	const uint64_t min_block_size = sizeof(block_header_t) + MM_ALIGNMENT;
+// Cada region es una lista fisica propia (prev_phys/next_phys terminan en NULL), asi nunca se unen bloques de regiones distintas
+static void simple_add_region(void *start, uint64_t size) {
+	const uint64_t min_block_size = BLOCK_HEADER_SIZE + MM_ALIGNMENT;
 
-	if (heap_size < min_block_size) {
-		mm_initialized_flag = 0;
-		heap_capacity_bytes = 0;
-		heap_used_bytes = 0;
-		heap_allocation_count = 0;
-		heap_free_count = 0;
-		heap_failed_allocations = 0;
+	uint64_t aligned_start = align_up((uint64_t) start, MM_ALIGNMENT);
+	if (aligned_start < (uint64_t) start) {
 		return;
 	}
 
-	uint64_t aligned_start = align_up((uint64_t) heap_start, MM_ALIGNMENT);
-	if (aligned_start < (uint64_t) heap_start) {
-		mm_initialized_flag = 0;
+	uint64_t alignment_loss = aligned_start - (uint64_t) start;
+	if (alignment_loss >= size) {
 		return;
 	}
 
-	uint64_t alignment_loss = aligned_start - (uint64_t) heap_start;
-	if (alignment_loss >= heap_size) {
-		mm_initialized_flag = 0;
-		return;
-	}
-
-	uint64_t usable_bytes = heap_size - alignment_loss;
-	usable_bytes &= ~(MM_ALIGNMENT - 1);
-
+	uint64_t usable_bytes = (size - alignment_loss) & ~(MM_ALIGNMENT - 1);
 	if (usable_bytes < min_block_size) {
-		mm_initialized_flag = 0;
-		heap_capacity_bytes = 0;
-		heap_used_bytes = 0;
-		heap_allocation_count = 0;
-		heap_free_count = 0;
-		heap_failed_allocations = 0;
 		return;
 	}
 
-	free_list_init();
-
 	block_header_t *initial_block = (block_header_t *) aligned_start;
 	initial_block->size_and_flags = usable_bytes;
 	initial_block->prev_phys = NULL;
@@ -190,53 +209,34 @@ void mm_init(void *heap_start, uint64_t heap_size) {
 
 	free_list_insert(initial_block);
 
-	heap_capacity_bytes = usable_bytes - sizeof(block_header_t);
-	heap_used_bytes = 0;
-	heap_allocation_count = 0;
-	heap_free_count = 0;
-	heap_failed_allocations = 0;
+	heap_capacity_bytes += usable_bytes - BLOCK_HEADER_SIZE;
 	mm_initialized_flag = 1;
 }
 
-static void mm_default_region(void **start, uint64_t *size) {
-	extern uint8_t endOfKernel;
-	const uint64_t raw_start = (uint64_t) &endOfKernel + MM_PAGE_SIZE * MM_KERNEL_STACK_PAGES;
-	const uint64_t aligned_start = align_up(raw_start, MM_ALIGNMENT);
-	const uint64_t heap_limit = MM_DEFAULT_HEAP_LIMIT;
-
-	if (aligned_start >= heap_limit) {
-		*start = NULL;
-		*size = 0;
-		return;
-	}
+static void simple_init(void *heap_start, uint64_t heap_size) {
+	free_list_init();
 
-	*start = (void *) aligned_start;
-	*size = heap_limit - aligned_start;
-}
+	mm_initialized_flag = 0;
+	heap_capacity_bytes = 0;
+	heap_used_bytes = 0;
+	heap_allocation_count = 0;
+	heap_free_count = 0;
+	heap_failed_allocations = 0;
 
-void mm_init_default(void) {
-	void *start = NULL;
-	uint64_t size = 0;
-	mm_default_region(&start, &size);
-	if (start != NULL && size > 0) {
-		mm_init(start, size);
-	}
+	simple_add_region(heap_start, heap_size);
 }
 
-void *mm_alloc(uint64_t size) {
+static void *simple_alloc(uint64_t size) {
 	if (!mm_initialized_flag) {
-		mm_init_default();
-		if (!mm_initialized_flag) {
-			heap_failed_allocations++;
-			return NULL;
-		}
+		heap_failed_allocations++;
+		return NULL;
 	}
 
 	if (size == 0) {
 		return NULL;
 	}
 
-	const uint64_t header_size = sizeof(block_header_t);
+	const uint64_t header_size = BLOCK_HEADER_SIZE;
 	const uint64_t min_block_size = header_size + MM_ALIGNMENT;
 
 	uint64_t aligned_size = align_up(size, MM_ALIGNMENT);
@@ -245,7 +245,7 @@ void *mm_alloc(uint64_t size) {
 		required_size = min_block_size;
 	}
 
-	block_header_t *block = find_first_fit(required_size);
+	block_header_t *block = find_fit(required_size);
 	if (block == NULL) {
 		heap_failed_allocations++;
 		return NULL;
@@ -264,19 +264,82 @@ void *mm_alloc(uint64_t size) {
 	return result;
 }
 
-void mm_free(void *ptr) {
+/*
+ * Busca un bloque con lugar para el pedido mas el peor relleno y corta el relleno inicial como bloque libre
+ * propio. Si el relleno no alcanza para un bloque minimo se avanza a la siguiente direccion alineada.
+ */
+static void *simple_alloc_aligned(uint64_t size, uint64_t align) {
+	if (align <= MM_ALIGNMENT) {
+		return simple_alloc(size);
+	}
+	if (!mm_initialized_flag) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+	if (size == 0 || (align & (align - 1))) {
+		return NULL;
+	}
+
+	const uint64_t header_size = BLOCK_HEADER_SIZE;
+	const uint64_t min_block_size = header_size + MM_ALIGNMENT;
+
+	uint64_t required_size = align_up(size, MM_ALIGNMENT) + header_size;
+	if (required_size < min_block_size) {
+		required_size = min_block_size;
+	}
+
+	block_header_t *block = find_fit(required_size + align + min_block_size);
+	if (block == NULL) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+	free_list_remove(block);
+
+	uint64_t payload = align_up((uint64_t) block + header_size, align);
+	uint64_t padding = payload - header_size - (uint64_t) block;
+	if (padding != 0 && padding < min_block_size) {
+		padding += align;
+	}
+
+	if (padding != 0) {
+		block_header_t *aligned = (block_header_t *) ((uint8_t *) block + padding);
+		aligned->size_and_flags = block_size(block) - padding;
+		aligned->prev_phys = block;
+		aligned->next_phys = block->next_phys;
+		if (aligned->next_phys != NULL) {
+			aligned->next_phys->prev_phys = aligned;
+		}
+		block->next_phys = aligned;
+		block->size_and_flags = padding;
+		free_list_insert(block);
+		block = aligned;
+	}
+
+	block = split_block_if_possible(block, required_size);
+	block_mark_allocated(block);
+
+	uint64_t payload_size = block_size(block) - header_size;
+	heap_used_bytes += payload_size;
+	if (heap_used_bytes > heap_capacity_bytes) {
+		heap_used_bytes = heap_capacity_bytes;
+	}
+	heap_allocation_count++;
+	return (uint8_t *) block + header_size;
+}
+
+static void simple_free(void *ptr) {
 	if (ptr == NULL || !mm_initialized_flag) {
 		return;
 	}
 
-	block_header_t *block = (block_header_t *) ((uint8_t *) ptr - sizeof(block_header_t));
+	block_header_t *block = (block_header_t *) ((uint8_t *) ptr - BLOCK_HEADER_SIZE);
 	if (!block_is_allocated(block)) {
 		return;
 	}
 	block_mark_free(block);
 	heap_free_count++;
 
-	uint64_t payload_size = block_size(block) - sizeof(block_header_t);
+	uint64_t payload_size = block_size(block) - BLOCK_HEADER_SIZE;
 	if (heap_used_bytes >= payload_size) {
 		heap_used_bytes -= payload_size;
 	}
@@ -291,22 +354,36 @@ void mm_free(void *ptr) {
 	free_list_insert(block);
 }
 
-void mm_get_stats(mm_stats_t *stats) {
+static uint64_t simple_usable_size(void *ptr) {
+	if (ptr == NULL || !mm_initialized_flag) {
+		return 0;
+	}
+	block_header_t *block = (block_header_t *) ((uint8_t *) ptr - BLOCK_HEADER_SIZE);
+	if (!block_is_allocated(block)) {
+		return 0;
+	}
+	return block_size(block) - BLOCK_HEADER_SIZE;
+}
+
+static void simple_get_stats(mm_stats_t *stats) {
 	if (stats == NULL) {
 		return;
 	}
 
 	uint64_t largest_block = 0;
-	for (block_header_t *current = free_list_sentinel.next_free; current != &free_list_sentinel;
-		 current = current->next_free) {
-		uint64_t current_size = block_size(current);
-		if (current_size > largest_block) {
-			largest_block = current_size;
+	if (nonempty_bins != 0) {
+		int top_bin = 63 - __builtin_clzll(nonempty_bins);
+		for (block_header_t *current = bin_sentinels[top_bin].next_free; current != &bin_sentinels[top_bin];
+			 current = current->next_free) {
+			uint64_t current_size = block_size(current);
+			if (current_size > largest_block) {
+				largest_block = current_size;
+			}
 		}
 	}
 
-	if (largest_block >= sizeof(block_header_t)) {
-		largest_block -= sizeof(block_header_t);
+	if (largest_block >= BLOCK_HEADER_SIZE) {
+		largest_block -= BLOCK_HEADER_SIZE;
 	}
 	else {
 		largest_block = 0;
@@ -319,15 +396,24 @@ void mm_get_stats(mm_stats_t *stats) {
 	stats->allocations = heap_allocation_count;
 	stats->frees = heap_free_count;
 	stats->failed_allocations = heap_failed_allocations;
+	stats->internal_fragmentation = 0;
+	stats->split_ops = 0;
+	stats->merge_ops = 0;
 }
 
-uint8_t mm_is_initialized(void) {
+static uint8_t simple_is_initialized(void) {
 	uint8_t initialized = mm_initialized_flag;
 	return initialized;
 }
 
-const char *mm_get_manager_name(void) {
-	return "simple";
-}
-
-#endif
+const mm_allocator_t mm_simple_allocator = {
+	.name = "simple",
+	.init = simple_init,
+	.add_region = simple_add_region,
+	.alloc = simple_alloc,
+	.alloc_aligned = simple_alloc_aligned,
+	.free = simple_free,
+	.usable_size = simple_usable_size,
+	.get_stats = simple_get_stats,
+	.is_initialized = simple_is_initialized,
+};
@@ -0,0 +1,445 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <mm_backend.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MM_ALIGNMENT 16ULL
+#define MM_ALIGNMENT_LOG2 4
+
+/*
+ * Two-level segregated fit (TLSF):
+ * - El primer nivel (fl) separa los bloques por potencia de dos.
+ * - El segundo nivel (sl) divide cada potencia de dos en 2^SL_INDEX_COUNT_LOG2 rangos lineales.
+ * - Un bitmap por nivel indica que listas tienen bloques, asi buscar y liberar es O(1).
+ * Los bloques menores a SMALL_BLOCK_SIZE caen todos en fl = 0 con rangos de MM_ALIGNMENT bytes.
+ */
+#define SL_INDEX_COUNT_LOG2 4
+#define SL_INDEX_COUNT (1U << SL_INDEX_COUNT_LOG2)
+#define FL_INDEX_SHIFT (SL_INDEX_COUNT_LOG2 + MM_ALIGNMENT_LOG2)
+#define FL_INDEX_MAX 40
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE (1ULL << FL_INDEX_SHIFT)
+
+#define BLOCK_FREE_FLAG 1ULL
+#define BLOCK_PREV_FREE_FLAG 2ULL
+#define BLOCK_FLAGS_MASK (BLOCK_FREE_FLAG | BLOCK_PREV_FREE_FLAG)
+
+typedef struct tlsf_block tlsf_block_t;
+
+/*
+ * prev_phys solo es valido si el bloque anterior esta libre (BLOCK_PREV_FREE_FLAG).
+ * next_free/prev_free viven en el payload, por lo que solo existen en bloques libres.
+ */
+struct tlsf_block {
+	tlsf_block_t *prev_phys;
+	uint64_t size_and_flags;
+	tlsf_block_t *next_free;
+	tlsf_block_t *prev_free;
+};
+
+#define BLOCK_HEADER_SIZE (2 * sizeof(uint64_t))
+#define BLOCK_MIN_SIZE (sizeof(tlsf_block_t))
+#define BLOCK_MAX_SIZE (1ULL << FL_INDEX_MAX)
+
+static uint64_t fl_bitmap = 0;
+static uint32_t sl_bitmap[FL_INDEX_COUNT];
+static tlsf_block_t *free_lists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+static uint8_t mm_initialized_flag = 0;
+static uint64_t heap_capacity_bytes = 0;
+static uint64_t heap_used_bytes = 0;
+static uint64_t heap_allocation_count = 0;
+static uint64_t heap_free_count = 0;
+static uint64_t heap_failed_allocations = 0;
+
+static inline uint64_t align_up(uint64_t value, uint64_t alignment) {
+	uint64_t result = (value + alignment - 1) & ~(alignment - 1);
+	return result;
+}
+
+static inline int fls_u64(uint64_t value) {
+	return value ? 63 - __builtin_clzll(value) : -1;
+}
+
+static inline int ffs_u64(uint64_t value) {
+	return value ? __builtin_ctzll(value) : -1;
+}
+
+static inline uint64_t block_size(const tlsf_block_t *block) {
+	return block->size_and_flags & ~BLOCK_FLAGS_MASK;
+}
+
+static inline void block_set_size(tlsf_block_t *block, uint64_t size) {
+	block->size_and_flags = size | (block->size_and_flags & BLOCK_FLAGS_MASK);
+}
+
+static inline int block_is_free(const tlsf_block_t *block) {
+	return (block->size_and_flags & BLOCK_FREE_FLAG) != 0;
+}
+
+static inline int block_is_prev_free(const tlsf_block_t *block) {
+	return (block->size_and_flags & BLOCK_PREV_FREE_FLAG) != 0;
+}
+
+static inline void *block_to_ptr(const tlsf_block_t *block) {
+	return (uint8_t *) block + BLOCK_HEADER_SIZE;
+}
+
+static inline tlsf_block_t *block_from_ptr(const void *ptr) {
+	return (tlsf_block_t *) ((uint8_t *) ptr - BLOCK_HEADER_SIZE);
+}
+
+static inline tlsf_block_t *block_next(const tlsf_block_t *block) {
+	return (tlsf_block_t *) ((uint8_t *) block + block_size(block));
+}
+
+static inline uint64_t block_payload(const tlsf_block_t *block) {
+	return block_size(block) - BLOCK_HEADER_SIZE;
+}
+
+static void block_mark_free(tlsf_block_t *block) {
+	tlsf_block_t *next = block_next(block);
+	block->size_and_flags |= BLOCK_FREE_FLAG;
+	next->prev_phys = block;
+	next->size_and_flags |= BLOCK_PREV_FREE_FLAG;
+}
+
+static void block_mark_used(tlsf_block_t *block) {
+	tlsf_block_t *next = block_next(block);
+	block->size_and_flags &= ~BLOCK_FREE_FLAG;
+	next->size_and_flags &= ~BLOCK_PREV_FREE_FLAG;
+}
+
+static void mapping_insert(uint64_t size, int *fli, int *sli) {
+	if (size < SMALL_BLOCK_SIZE) {
+		*fli = 0;
+		*sli = (int) (size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+		return;
+	}
+	int fl = fls_u64(size);
+	*sli = (int) ((size >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT);
+	*fli = fl - (FL_INDEX_SHIFT - 1);
+}
+
+// Redondea hacia arriba al proximo rango para que cualquier bloque de la lista encontrada sirva
+static void mapping_search(uint64_t size, int *fli, int *sli) {
+	if (size >= SMALL_BLOCK_SIZE) {
+		uint64_t round = (1ULL << (fls_u64(size) - SL_INDEX_COUNT_LOG2)) - 1;
+		size += round;
+	}
+	mapping_insert(size, fli, sli);
+}
+
+static tlsf_block_t *find_suitable_block(int *fli, int *sli) {
+	int fl = *fli;
+	int sl = *sli;
+
+	if (fl >= FL_INDEX_COUNT) {
+		return NULL;
+	}
+
+	uint32_t sl_map = sl_bitmap[fl] & (~0U << sl);
+	if (!sl_map) {
+		uint64_t fl_map = (fl + 1 < 64) ? (fl_bitmap & (~0ULL << (fl + 1))) : 0;
+		if (!fl_map) {
+			return NULL;
+		}
+		fl = ffs_u64(fl_map);
+		sl_map = sl_bitmap[fl];
+	}
+	sl = ffs_u64(sl_map);
+
+	*fli = fl;
+	*sli = sl;
+	return free_lists[fl][sl];
+}
+
+static void free_list_insert(tlsf_block_t *block) {
+	int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+
+	tlsf_block_t *head = free_lists[fl][sl];
+	block->prev_free = NULL;
+	block->next_free = head;
+	if (head != NULL) {
+		head->prev_free = block;
+	}
+	free_lists[fl][sl] = block;
+	fl_bitmap |= (1ULL << fl);
+	sl_bitmap[fl] |= (1U << sl);
+}
+
+static void free_list_remove(tlsf_block_t *block) {
+	int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+
+	if (block->prev_free != NULL) {
+		block->prev_free->next_free = block->next_free;
+	}
+	else {
+		free_lists[fl][sl] = block->next_free;
+	}
+	if (block->next_free != NULL) {
+		block->next_free->prev_free = block->prev_free;
+	}
+	block->next_free = NULL;
+	block->prev_free = NULL;
+
+	if (free_lists[fl][sl] == NULL) {
+		sl_bitmap[fl] &= ~(1U << sl);
+		if (sl_bitmap[fl] == 0) {
+			fl_bitmap &= ~(1ULL << fl);
+		}
+	}
+}
+
+static void split_block_if_possible(tlsf_block_t *block, uint64_t required_size) {
+	const uint64_t total_size = block_size(block);
+	if (total_size < required_size + BLOCK_MIN_SIZE) {
+		return;
+	}
+
+	tlsf_block_t *remaining = (tlsf_block_t *) ((uint8_t *) block + required_size);
+	remaining->size_and_flags = total_size - required_size;
+	block_set_size(block, required_size);
+
+	block_mark_free(remaining);
+	remaining->prev_phys = block;
+	remaining->size_and_flags &= ~BLOCK_PREV_FREE_FLAG;
+	free_list_insert(remaining);
+}
+
+static tlsf_block_t *coalesce_with_neighbors(tlsf_block_t *block) {
+	if (block_is_prev_free(block)) {
+		tlsf_block_t *prev = block->prev_phys;
+		free_list_remove(prev);
+		block_set_size(prev, block_size(prev) + block_size(block));
+		block = prev;
+	}
+
+	tlsf_block_t *next = block_next(block);
+	if (block_is_free(next)) {
+		free_list_remove(next);
+		block_set_size(block, block_size(block) + block_size(next));
+	}
+
+	return block;
+}
+
+static void mm_reset_counters(void) {
+	heap_capacity_bytes = 0;
+	heap_used_bytes = 0;
+	heap_allocation_count = 0;
+	heap_free_count = 0;
+	heap_failed_allocations = 0;
+}
+
+// Cada region termina en su propio centinela, asi coalesce nunca cruza a otra region
+static void tlsf_add_region(void *start, uint64_t size) {
+	uint64_t aligned_start = align_up((uint64_t) start, MM_ALIGNMENT);
+	uint64_t alignment_loss = aligned_start - (uint64_t) start;
+	if (aligned_start < (uint64_t) start || alignment_loss >= size) {
+		return;
+	}
+
+	uint64_t usable_bytes = (size - alignment_loss) & ~(MM_ALIGNMENT - 1);
+	if (usable_bytes >= BLOCK_MAX_SIZE) {
+		usable_bytes = BLOCK_MAX_SIZE - MM_ALIGNMENT;
+	}
+	// Se reserva un encabezado al final como centinela para que coalesce no salga de la region
+	if (usable_bytes < BLOCK_MIN_SIZE + BLOCK_HEADER_SIZE) {
+		return;
+	}
+
+	tlsf_block_t *initial_block = (tlsf_block_t *) aligned_start;
+	initial_block->prev_phys = NULL;
+	initial_block->size_and_flags = usable_bytes - BLOCK_HEADER_SIZE;
+
+	tlsf_block_t *sentinel = block_next(initial_block);
+	sentinel->prev_phys = initial_block;
+	sentinel->size_and_flags = 0;
+
+	block_mark_free(initial_block);
+	free_list_insert(initial_block);
+
+	heap_capacity_bytes += block_payload(initial_block);
+	mm_initialized_flag = 1;
+}
+
+static void tlsf_init(void *heap_start, uint64_t heap_size) {
+	mm_initialized_flag = 0;
+	mm_reset_counters();
+
+	fl_bitmap = 0;
+	for (int fl = 0; fl < FL_INDEX_COUNT; fl++) {
+		sl_bitmap[fl] = 0;
+		for (int sl = 0; sl < (int) SL_INDEX_COUNT; sl++) {
+			free_lists[fl][sl] = NULL;
+		}
+	}
+
+	tlsf_add_region(heap_start, heap_size);
+}
+
+static void *tlsf_alloc(uint64_t size) {
+	if (!mm_initialized_flag) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+
+	if (size == 0) {
+		return NULL;
+	}
+	if (size >= BLOCK_MAX_SIZE) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+
+	uint64_t required_size = align_up(size, MM_ALIGNMENT) + BLOCK_HEADER_SIZE;
+	if (required_size < BLOCK_MIN_SIZE) {
+		required_size = BLOCK_MIN_SIZE;
+	}
+
+	int fl, sl;
+	mapping_search(required_size, &fl, &sl);
+	tlsf_block_t *block = find_suitable_block(&fl, &sl);
+	if (block == NULL) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+
+	free_list_remove(block);
+	split_block_if_possible(block, required_size);
+	block_mark_used(block);
+
+	heap_used_bytes += block_payload(block);
+	heap_allocation_count++;
+	return block_to_ptr(block);
+}
+
+/*
+ * Igual que mm_backend_alloc pero pidiendo lugar para el peor relleno; el relleno inicial queda como bloque
+ * libre propio, o se avanza a la siguiente direccion alineada si no alcanza para un bloque minimo.
+ */
+static void *tlsf_alloc_aligned(uint64_t size, uint64_t align) {
+	if (align <= MM_ALIGNMENT) {
+		return tlsf_alloc(size);
+	}
+	if (!mm_initialized_flag) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+	if (size == 0 || (align & (align - 1)) || size >= BLOCK_MAX_SIZE - align) {
+		return NULL;
+	}
+
+	uint64_t required_size = align_up(size, MM_ALIGNMENT) + BLOCK_HEADER_SIZE;
+	if (required_size < BLOCK_MIN_SIZE) {
+		required_size = BLOCK_MIN_SIZE;
+	}
+
+	int fl, sl;
+	mapping_search(required_size + align + BLOCK_MIN_SIZE, &fl, &sl);
+	tlsf_block_t *block = find_suitable_block(&fl, &sl);
+	if (block == NULL) {
+		heap_failed_allocations++;
+		return NULL;
+	}
+	free_list_remove(block);
+
+	uint64_t payload = align_up((uint64_t) block_to_ptr(block), align);
+	uint64_t padding = payload - (uint64_t) block_to_ptr(block);
+	if (padding != 0 && padding < BLOCK_MIN_SIZE) {
+		padding += align;
+	}
+
+	if (padding != 0) {
+		tlsf_block_t *aligned = (tlsf_block_t *) ((uint8_t *) block + padding);
+		aligned->size_and_flags = block_size(block) - padding;
+		block_set_size(block, padding);
+		block_mark_free(block);
+		free_list_insert(block);
+		block = aligned;
+	}
+
+	split_block_if_possible(block, required_size);
+	block_mark_used(block);
+
+	heap_used_bytes += block_payload(block);
+	heap_allocation_count++;
+	return block_to_ptr(block);
+}
+
+static void tlsf_free(void *ptr) {
+	if (ptr == NULL || !mm_initialized_flag) {
+		return;
+	}
+
+	tlsf_block_t *block = block_from_ptr(ptr);
+	if (block_is_free(block)) {
+		return;
+	}
+
+	uint64_t payload_size = block_payload(block);
+	heap_used_bytes = (heap_used_bytes >= payload_size) ? heap_used_bytes - payload_size : 0;
+	heap_free_count++;
+
+	block = coalesce_with_neighbors(block);
+	block_mark_free(block);
+	free_list_insert(block);
+}
+
+static uint64_t tlsf_usable_size(void *ptr) {
+	if (ptr == NULL || !mm_initialized_flag) {
+		return 0;
+	}
+	tlsf_block_t *block = block_from_ptr(ptr);
+	return block_is_free(block) ? 0 : block_payload(block);
+}
+
+static void tlsf_get_stats(mm_stats_t *stats) {
+	if (stats == NULL) {
+		return;
+	}
+
+	// El bloque mas grande esta en la lista no vacia de mayor clase; solo hace falta recorrer esa
+	uint64_t largest_block = 0;
+	int fl = fls_u64(fl_bitmap);
+	if (fl >= 0) {
+		int sl = fls_u64(sl_bitmap[fl]);
+		for (tlsf_block_t *current = free_lists[fl][sl]; current != NULL; current = current->next_free) {
+			if (block_payload(current) > largest_block) {
+				largest_block = block_payload(current);
+			}
+		}
+	}
+
+	stats->total_bytes = heap_capacity_bytes;
+	stats->used_bytes = heap_used_bytes;
+	stats->free_bytes = (heap_capacity_bytes > heap_used_bytes) ? (heap_capacity_bytes - heap_used_bytes) : 0;
+	stats->largest_free_block = largest_block;
+	stats->allocations = heap_allocation_count;
+	stats->frees = heap_free_count;
+	stats->failed_allocations = heap_failed_allocations;
+	stats->internal_fragmentation = 0;
+	stats->split_ops = 0;
+	stats->merge_ops = 0;
+}
+
+static uint8_t tlsf_is_initialized(void) {
+	uint8_t initialized = mm_initialized_flag;
+	return initialized;
+}
+
+const mm_allocator_t mm_tlsf_allocator = {
+	.name = "tlsf",
+	.init = tlsf_init,
+	.add_region = tlsf_add_region,
+	.alloc = tlsf_alloc,
+	.alloc_aligned = tlsf_alloc_aligned,
+	.free = tlsf_free,
+	.usable_size = tlsf_usable_size,
+	.get_stats = tlsf_get_stats,
+	.is_initialized = tlsf_is_initialized,
+};
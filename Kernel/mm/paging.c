@@ -0,0 +1,571 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <lib.h>
+#include <memory_map.h>
+#include <mm.h>
+#include <paging.h>
+#include <scheduler.h>
+#include <slab.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PTE_PRESENT (1ULL << 0)
+#define PTE_WRITE (1ULL << 1)
+#define PTE_USER (1ULL << 2)
+#define PTE_LARGE (1ULL << 7)
+#define PTE_GLOBAL (1ULL << 8)
+#define PTE_ADDR_MASK 0x000FFFFFFFFFF000ULL
+#define TABLE_ENTRIES 512
+#define GIGABYTE (1ULL << 30)
+
+#define CR3_NOFLUSH (1ULL << 63)
+#define CR4_PGE (1ULL << 7)
+#define CR4_PCIDE (1ULL << 17)
+#define CPUID_ECX_PCID (1U << 17)
+#define MAX_PCID 4096
+
+#define USER_PML4_SLOT (PAGING_USER_BASE >> 39)
+#define STACK_PML4_SLOT (PAGING_STACK_BASE >> 39)
+
+/*
+ * Con PCID cada espacio de direcciones etiqueta sus entradas de la TLB, asi que cambiar de CR3 no las descarta.
+ * El PCID 0 es del kernel; si se agotan, el proceso comparte el 0 y cada carga vacia la TLB como sin PCID.
+ * flush_epoch invalida de una vez todas las etiquetas (al apagar o prender PCID cambia el significado de CR3).
+ */
+struct address_space {
+	uint64_t *pml4;
+	uint64_t user_pages;
+	uint64_t epoch;
+	uint16_t pcid;
+	uint8_t needs_flush; // hay entradas viejas con este PCID: la proxima carga no puede conservarlas
+};
+
+static uint64_t *kernel_pml4 = NULL;
+static uint8_t enabled = 0;
+static uint8_t pcid_supported = 0;
+static uint8_t pcid_enabled = 0;
+static uint64_t identity_bytes = 0;
+
+static address_space_t *loaded_as = NULL; // NULL = tablas del kernel
+static uint64_t flush_epoch = 0;
+static uint64_t kernel_epoch = 0;
+static uint8_t pcid0_shared = 0; // algun proceso sin PCID propio dejo entradas con el PCID 0
+
+static uint8_t pcid_used[MAX_PCID / 8];
+static uint16_t pcid_next = 1;
+static slab_cache_t *space_cache = NULL;
+
+// Tamaño de cada stack (0 = slot libre) y paginas en cero listas para mapear desde el page fault
+static uint32_t stack_sizes[PAGING_MAX_STACKS];
+static uint32_t stack_next = 0;
+static void *stack_reserve[PAGING_STACK_RESERVE];
+static uint64_t stack_reserve_count = 0;
+
+static uint64_t address_spaces = 0;
+static uint64_t user_pages = 0;
+static uint64_t table_pages = 0;
+static uint64_t switches = 0;
+static uint64_t flushes = 0;
+static uint64_t stacks = 0;
+static uint64_t stack_pages = 0;
+static uint64_t stack_faults = 0;
+
+static uint64_t *table_alloc(void) {
+	uint64_t *table = (uint64_t *) mm_alloc_pages(0);
+	if (table) {
+		memset(table, 0, PAGING_PAGE_SIZE);
+		table_pages++;
+	}
+	return table;
+}
+
+static void table_free(uint64_t *table) {
+	mm_free_pages(table);
+	table_pages--;
+}
+
+static inline uint64_t *entry_table(uint64_t entry) {
+	return (uint64_t *) (entry & PTE_ADDR_MASK);
+}
+
+static uint16_t pcid_alloc(void) {
+	for (int i = 1; i < MAX_PCID; i++) {
+		uint16_t id = pcid_next;
+		pcid_next = (uint16_t) (pcid_next % (MAX_PCID - 1) + 1);
+		if (!(pcid_used[id / 8] & (1 << (id % 8)))) {
+			pcid_used[id / 8] |= (uint8_t) (1 << (id % 8));
+			return id;
+		}
+	}
+	return 0;
+}
+
+static void pcid_release(uint16_t id) {
+	if (id)
+		pcid_used[id / 8] &= (uint8_t) ~(1 << (id % 8));
+}
+
+static void load_space(address_space_t *as) {
+	uint64_t cr3 = as ? (uint64_t) as->pml4 : (uint64_t) kernel_pml4;
+	int flush = 1;
+
+	if (pcid_enabled) {
+		if (as && as->pcid == 0) {
+			pcid0_shared = 1;
+		}
+		else {
+			uint64_t *epoch = as ? &as->epoch : &kernel_epoch;
+			flush = (*epoch != flush_epoch) || (as ? as->needs_flush : pcid0_shared);
+			*epoch = flush_epoch;
+			if (as) {
+				cr3 |= as->pcid;
+				as->needs_flush = 0;
+			}
+			else {
+				pcid0_shared = 0;
+			}
+			if (!flush)
+				cr3 |= CR3_NOFLUSH;
+		}
+	}
+
+	write_cr3(cr3);
+	loaded_as = as;
+	switches++;
+	if (flush)
+		flushes++;
+}
+
+/*
+ * Identidad de [0, tope) con paginas de 2 MB globales. El tope es la RAM informada mas 4 GB (el hueco de MMIO
+ * por debajo de 4 GB puede correr la RAM hacia arriba), redondeado a GB y sin pasar lo que mapeaba Pure64.
+ */
+void paging_init(void) {
+	if (enabled)
+		return;
+
+	uint64_t top = memory_map_total_mb() * 1024 * 1024 + PAGING_MIN_IDENTITY;
+	top = (top + GIGABYTE - 1) & ~(GIGABYTE - 1);
+	if (top > MEMORY_MAP_MAPPED_LIMIT)
+		top = MEMORY_MAP_MAPPED_LIMIT;
+
+	space_cache = slab_cache_create("address_space", sizeof(address_space_t), NULL);
+	uint64_t *pml4 = table_alloc();
+	uint64_t *pdpt = table_alloc();
+	uint64_t *stack_pdpt = table_alloc();
+	if (!space_cache || !pml4 || !pdpt || !stack_pdpt) {
+		if (pml4)
+			table_free(pml4);
+		if (pdpt)
+			table_free(pdpt);
+		if (stack_pdpt)
+			table_free(stack_pdpt);
+		return;
+	}
+
+	for (uint64_t gb = 0; gb < top / GIGABYTE; gb++) {
+		uint64_t *pd = table_alloc();
+		if (!pd) {
+			// Sin memoria para todo el rango: se sigue con lo de Pure64
+			for (uint64_t i = 0; i < gb; i++)
+				table_free(entry_table(pdpt[i]));
+			table_free(stack_pdpt);
+			table_free(pdpt);
+			table_free(pml4);
+			return;
+		}
+		for (uint64_t i = 0; i < TABLE_ENTRIES; i++)
+			pd[i] = (gb * GIGABYTE + i * PAGING_LARGE_PAGE_SIZE) | PTE_PRESENT | PTE_WRITE | PTE_LARGE | PTE_GLOBAL;
+		pdpt[gb] = (uint64_t) pd | PTE_PRESENT | PTE_WRITE;
+	}
+	pml4[0] = (uint64_t) pdpt | PTE_PRESENT | PTE_WRITE;
+	// Todas las PML4 de procesos copian esta entrada: las tablas de stacks que se agreguen despues se ven en todas
+	pml4[STACK_PML4_SLOT] = (uint64_t) stack_pdpt | PTE_PRESENT | PTE_WRITE;
+
+	uint64_t flags = irq_save();
+	kernel_pml4 = pml4;
+	identity_bytes = top;
+	write_cr4(read_cr4() | CR4_PGE);
+	write_cr3((uint64_t) kernel_pml4);
+	// PCIDE solo se puede prender con el PCID 0 en CR3
+	pcid_supported = (cpuid_ecx(1) & CPUID_ECX_PCID) != 0;
+	if (pcid_supported) {
+		write_cr4(read_cr4() | CR4_PCIDE);
+		pcid_enabled = 1;
+	}
+	loaded_as = NULL;
+	enabled = 1;
+	irq_restore(flags);
+}
+
+uint8_t paging_is_enabled(void) {
+	return enabled;
+}
+
+static address_space_t *space_create(process_t *p) {
+	address_space_t *as = (address_space_t *) slab_alloc(space_cache);
+	if (!as)
+		return NULL;
+	as->pml4 = table_alloc();
+	if (!as->pml4) {
+		slab_free(space_cache, as);
+		return NULL;
+	}
+	memcpy(as->pml4, kernel_pml4, PAGING_PAGE_SIZE);
+	as->user_pages = 0;
+	as->epoch = flush_epoch;
+	as->pcid = pcid_supported ? pcid_alloc() : 0;
+	// Un PCID reciclado puede tener entradas del duenio anterior
+	as->needs_flush = 1;
+	p->aspace = as;
+	address_spaces++;
+	return as;
+}
+
+// Entrada de la tabla final para va; con create arma las tablas intermedias que falten
+static uint64_t *walk_from(uint64_t *pml4, uint64_t va, int create) {
+	uint64_t *table = pml4;
+	for (int level = 3; level > 0; level--) {
+		uint64_t idx = (va >> (12 + 9 * level)) & (TABLE_ENTRIES - 1);
+		if (!(table[idx] & PTE_PRESENT)) {
+			if (!create)
+				return NULL;
+			uint64_t *next = table_alloc();
+			if (!next)
+				return NULL;
+			table[idx] = (uint64_t) next | PTE_PRESENT | PTE_WRITE | PTE_USER;
+		}
+		table = entry_table(table[idx]);
+	}
+	return &table[(va >> 12) & (TABLE_ENTRIES - 1)];
+}
+
+static uint64_t *walk(address_space_t *as, uint64_t va, int create) {
+	return walk_from(as->pml4, va, create);
+}
+
+// Saca las paginas de [va, va + pages) y libera las tablas finales que quedan vacias
+static void unmap_range(address_space_t *as, uint64_t va, uint64_t pages) {
+	uint64_t end = va + pages * PAGING_PAGE_SIZE;
+	for (uint64_t addr = va; addr < end; addr += PAGING_PAGE_SIZE) {
+		uint64_t *pte = walk(as, addr, 0);
+		if (pte && (*pte & PTE_PRESENT)) {
+			*pte = 0;
+			as->user_pages--;
+			user_pages--;
+		}
+	}
+
+	for (uint64_t chunk = va & ~(PAGING_LARGE_PAGE_SIZE - 1); chunk < end; chunk += PAGING_LARGE_PAGE_SIZE) {
+		if (!(as->pml4[USER_PML4_SLOT] & PTE_PRESENT))
+			break;
+		uint64_t *pdpt = entry_table(as->pml4[USER_PML4_SLOT]);
+		uint64_t pdpt_entry = pdpt[(chunk >> 30) & (TABLE_ENTRIES - 1)];
+		if (!(pdpt_entry & PTE_PRESENT))
+			continue;
+		uint64_t *pd = entry_table(pdpt_entry);
+		uint64_t *pde = &pd[(chunk >> 21) & (TABLE_ENTRIES - 1)];
+		if (!(*pde & PTE_PRESENT))
+			continue;
+		uint64_t *pt = entry_table(*pde);
+		int empty = 1;
+		for (int i = 0; i < TABLE_ENTRIES && empty; i++)
+			empty = (pt[i] == 0);
+		if (empty) {
+			*pde = 0;
+			table_free(pt);
+		}
+	}
+
+	// invlpg tambien descarta las tablas intermedias cacheadas para esas direcciones
+	if (loaded_as == as) {
+		for (uint64_t addr = va; addr < end; addr += PAGING_PAGE_SIZE)
+			flush_tlb_page((void *) addr);
+	}
+	else {
+		as->needs_flush = 1;
+	}
+}
+
+void *paging_map_user(process_t *p, void *phys, uint64_t size) {
+	if (!enabled)
+		return phys;
+	uint64_t base = (uint64_t) phys;
+	if (!p || size == 0 || (base & (PAGING_PAGE_SIZE - 1)) || base + size > identity_bytes ||
+		PAGING_USER_BASE + base + size > PAGING_LOCAL_PAGE)
+		return NULL;
+
+	uint64_t flags = irq_save();
+	address_space_t *as = p->aspace ? p->aspace : space_create(p);
+	void *user = NULL;
+	if (as) {
+		uint64_t va = PAGING_USER_BASE + base;
+		uint64_t pages = (size + PAGING_PAGE_SIZE - 1) / PAGING_PAGE_SIZE;
+		uint64_t mapped = 0;
+		while (mapped < pages) {
+			uint64_t *pte = walk(as, va + mapped * PAGING_PAGE_SIZE, 1);
+			if (!pte)
+				break;
+			*pte = (base + mapped * PAGING_PAGE_SIZE) | PTE_PRESENT | PTE_WRITE | PTE_USER;
+			as->user_pages++;
+			user_pages++;
+			mapped++;
+		}
+		if (mapped == pages)
+			user = (void *) va;
+		else
+			unmap_range(as, va, mapped);
+
+		// El proceso en ejecucion pasa a su propio espacio apenas tiene algo mapeado
+		if (user && p == scheduler_current_process() && loaded_as != as)
+			load_space(as);
+	}
+	irq_restore(flags);
+	return user;
+}
+
+void *paging_map_local(process_t *p, void *phys) {
+	if (!enabled)
+		return phys;
+	if (!p || ((uint64_t) phys & (PAGING_PAGE_SIZE - 1)))
+		return NULL;
+
+	uint64_t flags = irq_save();
+	address_space_t *as = p->aspace ? p->aspace : space_create(p);
+	uint64_t *pte = as ? walk(as, PAGING_LOCAL_PAGE, 1) : NULL;
+	void *local = NULL;
+	if (pte) {
+		*pte = (uint64_t) phys | PTE_PRESENT | PTE_WRITE | PTE_USER;
+		as->user_pages++;
+		user_pages++;
+		local = (void *) PAGING_LOCAL_PAGE;
+		if (p == scheduler_current_process() && loaded_as != as)
+			load_space(as);
+	}
+	irq_restore(flags);
+	return local;
+}
+
+void paging_unmap_user(process_t *p, void *user_addr, uint64_t size) {
+	if (!enabled || !p || !p->aspace || size == 0)
+		return;
+	uint64_t va = (uint64_t) user_addr & ~(PAGING_PAGE_SIZE - 1);
+	uint64_t flags = irq_save();
+	unmap_range(p->aspace, va, ((uint64_t) user_addr + size - va + PAGING_PAGE_SIZE - 1) / PAGING_PAGE_SIZE);
+	irq_restore(flags);
+}
+
+void *paging_user_to_phys(void *user_addr) {
+	uint64_t addr = (uint64_t) user_addr;
+	if (enabled && addr >= PAGING_USER_BASE && addr < PAGING_USER_BASE + PAGING_USER_SIZE)
+		return (void *) (addr - PAGING_USER_BASE);
+	return user_addr;
+}
+
+void *paging_phys_to_user(void *phys) {
+	return enabled ? (void *) ((uint64_t) phys + PAGING_USER_BASE) : phys;
+}
+
+static void free_level(uint64_t *table, int level) {
+	if (level > 1) {
+		for (int i = 0; i < TABLE_ENTRIES; i++) {
+			if (table[i] & PTE_PRESENT)
+				free_level(entry_table(table[i]), level - 1);
+		}
+	}
+	table_free(table);
+}
+
+void paging_destroy(process_t *p) {
+	if (!p || !p->aspace)
+		return;
+
+	uint64_t flags = irq_save();
+	address_space_t *as = p->aspace;
+	if (loaded_as == as)
+		load_space(NULL);
+	if (as->pml4[USER_PML4_SLOT] & PTE_PRESENT)
+		free_level(entry_table(as->pml4[USER_PML4_SLOT]), 3);
+	table_free(as->pml4);
+	user_pages -= as->user_pages;
+	pcid_release(as->pcid);
+	address_spaces--;
+	p->aspace = NULL;
+	slab_free(space_cache, as);
+	irq_restore(flags);
+}
+
+static void *stack_page_take(int can_alloc) {
+	if (stack_reserve_count > 0)
+		return stack_reserve[--stack_reserve_count];
+	return can_alloc ? mm_alloc_zeroed_for(MM_USE_STACKS, PAGING_PAGE_SIZE) : NULL;
+}
+
+// Las paginas devueltas se limpian para que la reserva siga siendo de paginas en cero
+static void stack_page_give(void *page) {
+	if (stack_reserve_count < PAGING_STACK_RESERVE) {
+		memset(page, 0, PAGING_PAGE_SIZE);
+		stack_reserve[stack_reserve_count++] = page;
+	}
+	else {
+		mm_free(page);
+	}
+}
+
+void paging_stack_refill(void) {
+	if (!enabled)
+		return;
+	uint64_t flags = irq_save();
+	while (stack_reserve_count < PAGING_STACK_RESERVE) {
+		void *page = mm_alloc_zeroed_for(MM_USE_STACKS, PAGING_PAGE_SIZE);
+		if (!page)
+			break;
+		stack_reserve[stack_reserve_count++] = page;
+	}
+	irq_restore(flags);
+}
+
+static int stack_slot_of(uint64_t addr) {
+	if (addr < PAGING_STACK_BASE || addr >= PAGING_STACK_BASE + PAGING_MAX_STACKS * PAGING_STACK_SLOT_SIZE)
+		return -1;
+	return (int) ((addr - PAGING_STACK_BASE) / PAGING_STACK_SLOT_SIZE);
+}
+
+static inline uint64_t stack_slot_top(int slot) {
+	return PAGING_STACK_BASE + (uint64_t) (slot + 1) * PAGING_STACK_SLOT_SIZE;
+}
+
+static void stack_map(uint64_t va, void *page) {
+	// Globales: el rango se ve igual en todos los espacios y no hace falta vaciarlo al cambiar de CR3
+	*walk_from(kernel_pml4, va, 0) = (uint64_t) page | PTE_PRESENT | PTE_WRITE | PTE_GLOBAL;
+	stack_pages++;
+}
+
+// Las tablas del slot se arman aca (contexto normal) para que el page fault solo tenga que escribir la entrada
+void *paging_stack_alloc(uint64_t size) {
+	if (!enabled || size == 0 || (size & (PAGING_PAGE_SIZE - 1)) || size > PAGING_STACK_SLOT_SIZE - PAGING_PAGE_SIZE)
+		return NULL;
+	paging_stack_refill();
+
+	uint64_t flags = irq_save();
+	int slot = -1;
+	for (int i = 0; i < PAGING_MAX_STACKS && slot < 0; i++) {
+		int candidate = (int) ((stack_next + i) % PAGING_MAX_STACKS);
+		if (stack_sizes[candidate] == 0)
+			slot = candidate;
+	}
+	void *base = NULL;
+	if (slot >= 0) {
+		uint64_t top = stack_slot_top(slot);
+		int ok = 1;
+		for (uint64_t va = top - size; va < top && ok; va += PAGING_PAGE_SIZE)
+			ok = walk_from(kernel_pml4, va, 1) != NULL;
+		void *page = ok ? stack_page_take(1) : NULL;
+		if (page) {
+			stack_map(top - PAGING_PAGE_SIZE, page);
+			stack_sizes[slot] = (uint32_t) size;
+			stack_next = (uint32_t) (slot + 1) % PAGING_MAX_STACKS;
+			stacks++;
+			base = (void *) (top - size);
+		}
+	}
+	irq_restore(flags);
+	return base;
+}
+
+int paging_stack_free(void *base) {
+	int slot = stack_slot_of((uint64_t) base);
+	if (slot < 0 || stack_sizes[slot] == 0)
+		return 0;
+
+	uint64_t flags = irq_save();
+	uint64_t top = stack_slot_top(slot);
+	for (uint64_t va = top - stack_sizes[slot]; va < top; va += PAGING_PAGE_SIZE) {
+		uint64_t *pte = walk_from(kernel_pml4, va, 0);
+		if (pte && (*pte & PTE_PRESENT)) {
+			void *page = entry_table(*pte);
+			*pte = 0;
+			flush_tlb_page((void *) va);
+			stack_page_give(page);
+			stack_pages--;
+		}
+	}
+	stack_sizes[slot] = 0;
+	stacks--;
+	irq_restore(flags);
+	return 1;
+}
+
+uint64_t paging_stack_resident(void *base) {
+	int slot = stack_slot_of((uint64_t) base);
+	if (slot < 0 || stack_sizes[slot] == 0)
+		return 0;
+	uint64_t resident = 0;
+	uint64_t top = stack_slot_top(slot);
+	for (uint64_t va = top - stack_sizes[slot]; va < top; va += PAGING_PAGE_SIZE) {
+		uint64_t *pte = walk_from(kernel_pml4, va, 0);
+		if (pte && (*pte & PTE_PRESENT))
+			resident += PAGING_PAGE_SIZE;
+	}
+	return resident;
+}
+
+// Lo llama el page fault con las interrupciones deshabilitadas; un acceso a la guarda devuelve 0
+int paging_stack_fault(uint64_t addr, int can_alloc) {
+	int slot = enabled ? stack_slot_of(addr) : -1;
+	if (slot < 0 || stack_sizes[slot] == 0 || addr < stack_slot_top(slot) - stack_sizes[slot])
+		return 0;
+	void *page = stack_page_take(can_alloc);
+	if (!page)
+		return 0;
+	stack_map(addr & ~(PAGING_PAGE_SIZE - 1), page);
+	stack_faults++;
+	return 1;
+}
+
+void paging_switch(process_t *next) {
+	if (!enabled)
+		return;
+	address_space_t *as = next ? next->aspace : NULL;
+	if (as != loaded_as)
+		load_space(as);
+}
+
+int paging_set_pcid(int on) {
+	if (!enabled || (on && !pcid_supported))
+		return 0;
+
+	uint64_t flags = irq_save();
+	if ((on != 0) != pcid_enabled) {
+		address_space_t *as = loaded_as;
+		// PCIDE solo se puede prender con el PCID 0 cargado; apagarlo vacia toda la TLB no global
+		write_cr3((uint64_t) kernel_pml4);
+		uint64_t cr4 = read_cr4();
+		write_cr4(on ? (cr4 | CR4_PCIDE) : (cr4 & ~CR4_PCIDE));
+		pcid_enabled = (on != 0);
+		flush_epoch++;
+		loaded_as = NULL;
+		load_space(as);
+	}
+	irq_restore(flags);
+	return 1;
+}
+
+void paging_get_stats(paging_stats_t *stats) {
+	if (!stats)
+		return;
+	uint64_t flags = irq_save();
+	stats->enabled = enabled;
+	stats->pcid_supported = pcid_supported;
+	stats->pcid_enabled = pcid_enabled;
+	stats->identity_bytes = identity_bytes;
+	stats->address_spaces = address_spaces;
+	stats->user_pages = user_pages;
+	stats->table_pages = table_pages;
+	stats->switches = switches;
+	stats->flushes = flushes;
+	stats->stacks = stacks;
+	stats->stack_pages = stack_pages;
+	stats->stack_faults = stack_faults;
+	irq_restore(flags);
+}
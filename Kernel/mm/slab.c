@@ -0,0 +1,242 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <mm.h>
+#include <slab.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SLAB_PAGE_SIZE 0x1000ULL
+#define SLAB_ALIGNMENT 16ULL
+#define SLAB_MIN_OBJECTS 8ULL
+#define SLAB_MAX_EMPTY 1ULL
+
+typedef struct slab slab_t;
+typedef struct slab_bufctl slab_bufctl_t;
+
+/*
+ * Cada objeto va precedido por un bufctl con su slab, asi slab_free es O(1) sin exigir slabs alineados.
+ * El enlace de la lista libre vive en el bufctl y no en el objeto, para no pisar el estado construido.
+ */
+struct slab_bufctl {
+	slab_t *slab;
+	slab_bufctl_t *next_free;
+};
+
+#define BUFCTL_ALLOCATED ((slab_bufctl_t *) 1)
+
+typedef enum { SLAB_LIST_EMPTY = 0, SLAB_LIST_PARTIAL, SLAB_LIST_FULL, SLAB_LIST_COUNT } slab_list_t;
+
+struct slab {
+	slab_cache_t *cache;
+	slab_t *next;
+	slab_t *prev;
+	slab_bufctl_t *free_list;
+	uint64_t in_use;
+	slab_list_t list;
+};
+
+struct slab_cache {
+	char name[SLAB_NAME_MAX_LEN + 1];
+	uint64_t object_size;
+	uint64_t stride;
+	uint64_t objects_per_slab;
+	uint64_t slab_bytes;
+	slab_ctor_t ctor;
+	slab_t *lists[SLAB_LIST_COUNT];
+	uint64_t list_counts[SLAB_LIST_COUNT];
+	uint64_t active_objects;
+	uint64_t allocations;
+	uint64_t frees;
+	int used;
+};
+
+#define SLAB_HEADER_SIZE align_up(sizeof(slab_t), SLAB_ALIGNMENT)
+
+static slab_cache_t caches[MAX_SLAB_CACHES];
+
+static inline uint64_t align_up(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void copy_name(char *dst, const char *src) {
+	const char *name = src ? src : "cache";
+	int i = 0;
+	while (i < SLAB_NAME_MAX_LEN && name[i] != '\0') {
+		dst[i] = name[i];
+		i++;
+	}
+	dst[i] = '\0';
+}
+
+static void slab_list_push(slab_cache_t *cache, slab_t *slab, slab_list_t list) {
+	slab->list = list;
+	slab->prev = NULL;
+	slab->next = cache->lists[list];
+	if (slab->next)
+		slab->next->prev = slab;
+	cache->lists[list] = slab;
+	cache->list_counts[list]++;
+}
+
+static void slab_list_remove(slab_cache_t *cache, slab_t *slab) {
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		cache->lists[slab->list] = slab->next;
+	if (slab->next)
+		slab->next->prev = slab->prev;
+	slab->next = slab->prev = NULL;
+	cache->list_counts[slab->list]--;
+}
+
+static void slab_list_move(slab_cache_t *cache, slab_t *slab, slab_list_t list) {
+	if (slab->list == list)
+		return;
+	slab_list_remove(cache, slab);
+	slab_list_push(cache, slab, list);
+}
+
+static slab_t *slab_grow(slab_cache_t *cache) {
+	slab_t *slab = (slab_t *) mm_alloc_for(MM_USE_PAGES, cache->slab_bytes);
+	if (!slab)
+		return NULL;
+
+	slab->cache = cache;
+	slab->in_use = 0;
+	slab->free_list = NULL;
+
+	uint8_t *cursor = (uint8_t *) slab + SLAB_HEADER_SIZE;
+	for (uint64_t i = 0; i < cache->objects_per_slab; i++) {
+		slab_bufctl_t *bufctl = (slab_bufctl_t *) (cursor + (cache->objects_per_slab - 1 - i) * cache->stride);
+		bufctl->slab = slab;
+		bufctl->next_free = slab->free_list;
+		slab->free_list = bufctl;
+		if (cache->ctor)
+			cache->ctor((uint8_t *) bufctl + sizeof(slab_bufctl_t));
+	}
+
+	slab_list_push(cache, slab, SLAB_LIST_EMPTY);
+	return slab;
+}
+
+slab_cache_t *slab_cache_create(const char *name, uint64_t object_size, slab_ctor_t ctor) {
+	if (object_size == 0)
+		return NULL;
+
+	slab_cache_t *cache = NULL;
+	for (int i = 0; i < MAX_SLAB_CACHES; i++) {
+		if (!caches[i].used) {
+			cache = &caches[i];
+			break;
+		}
+	}
+	if (!cache)
+		return NULL;
+
+	copy_name(cache->name, name);
+	cache->object_size = object_size;
+	cache->stride = align_up(sizeof(slab_bufctl_t) + object_size, SLAB_ALIGNMENT);
+	cache->slab_bytes = align_up(SLAB_HEADER_SIZE + SLAB_MIN_OBJECTS * cache->stride, SLAB_PAGE_SIZE);
+	cache->objects_per_slab = (cache->slab_bytes - SLAB_HEADER_SIZE) / cache->stride;
+	cache->ctor = ctor;
+	for (int l = 0; l < SLAB_LIST_COUNT; l++) {
+		cache->lists[l] = NULL;
+		cache->list_counts[l] = 0;
+	}
+	cache->active_objects = 0;
+	cache->allocations = 0;
+	cache->frees = 0;
+	cache->used = 1;
+	return cache;
+}
+
+void *slab_alloc(slab_cache_t *cache) {
+	if (!cache || !cache->used)
+		return NULL;
+
+	slab_t *slab = cache->lists[SLAB_LIST_PARTIAL];
+	if (!slab)
+		slab = cache->lists[SLAB_LIST_EMPTY];
+	if (!slab)
+		slab = slab_grow(cache);
+	if (!slab)
+		return NULL;
+
+	slab_bufctl_t *bufctl = slab->free_list;
+	slab->free_list = bufctl->next_free;
+	bufctl->next_free = BUFCTL_ALLOCATED;
+	slab->in_use++;
+
+	slab_list_move(cache, slab, (slab->in_use == cache->objects_per_slab) ? SLAB_LIST_FULL : SLAB_LIST_PARTIAL);
+
+	cache->active_objects++;
+	cache->allocations++;
+	return (uint8_t *) bufctl + sizeof(slab_bufctl_t);
+}
+
+void slab_free(slab_cache_t *cache, void *obj) {
+	if (!cache || !obj)
+		return;
+
+	slab_bufctl_t *bufctl = (slab_bufctl_t *) ((uint8_t *) obj - sizeof(slab_bufctl_t));
+	slab_t *slab = bufctl->slab;
+	if (!slab || slab->cache != cache || bufctl->next_free != BUFCTL_ALLOCATED)
+		return;
+
+	bufctl->next_free = slab->free_list;
+	slab->free_list = bufctl;
+	slab->in_use--;
+	cache->active_objects--;
+	cache->frees++;
+
+	if (slab->in_use > 0) {
+		slab_list_move(cache, slab, SLAB_LIST_PARTIAL);
+		return;
+	}
+
+	// Se conserva un slab vacio para absorber el churn de crear/destruir; el resto vuelve al heap
+	if (cache->list_counts[SLAB_LIST_EMPTY] >= SLAB_MAX_EMPTY) {
+		slab_list_remove(cache, slab);
+		mm_free(slab);
+	}
+	else {
+		slab_list_move(cache, slab, SLAB_LIST_EMPTY);
+	}
+}
+
+void slab_cache_reap(slab_cache_t *cache) {
+	if (!cache)
+		return;
+	while (cache->lists[SLAB_LIST_EMPTY]) {
+		slab_t *slab = cache->lists[SLAB_LIST_EMPTY];
+		slab_list_remove(cache, slab);
+		mm_free(slab);
+	}
+}
+
+uint64_t slab_get_info(slab_info_t *buffer, uint64_t max_count) {
+	if (!buffer || max_count == 0)
+		return 0;
+
+	uint64_t count = 0;
+	for (int i = 0; i < MAX_SLAB_CACHES && count < max_count; i++) {
+		slab_cache_t *cache = &caches[i];
+		if (!cache->used)
+			continue;
+
+		slab_info_t *info = &buffer[count++];
+		copy_name(info->name, cache->name);
+		info->object_size = cache->object_size;
+		info->objects_per_slab = cache->objects_per_slab;
+		info->slab_bytes = cache->slab_bytes;
+		info->slabs_full = cache->list_counts[SLAB_LIST_FULL];
+		info->slabs_partial = cache->list_counts[SLAB_LIST_PARTIAL];
+		info->slabs_empty = cache->list_counts[SLAB_LIST_EMPTY];
+		info->active_objects = cache->active_objects;
+		info->total_objects =
+			(info->slabs_full + info->slabs_partial + info->slabs_empty) * cache->objects_per_slab;
+		info->allocations = cache->allocations;
+		info->frees = cache->frees;
+	}
+	return count;
+}
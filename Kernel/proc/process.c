@@ -1,8 +1,12 @@
 // This is a personal academic project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <mm.h>
+#include <paging.h>
 #include <pipe.h>
+#include <poll.h>
 #include <process.h>
+#include <shm.h>
+#include <slab.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -13,6 +17,7 @@
 extern uint64_t setup_process_context(void *stack_top, void *entry_point, void *arg);
 
 static uint64_t next_pid = 1;
+static slab_cache_t *process_cache = NULL;
 
 static void copy_name(process_t *p, const char *name) {
 	const char *src = (name ? name : "proc");
@@ -31,6 +36,9 @@ static void copy_name(process_t *p, const char *name) {
 
 void process_system_init(void) {
 	next_pid = 1;
+	if (!process_cache)
+		process_cache = slab_cache_create("process_t", sizeof(process_t), NULL);
+	process_memory_init();
 }
 
 process_t *process_create(const char *name, process_entry_point_t entry_point, void *entry_arg, process_t *parent,
@@ -38,14 +46,17 @@ process_t *process_create(const char *name, process_entry_point_t entry_point, v
 	if (!entry_point)
 		return NULL;
 
-	process_t *p = (process_t *) mm_alloc(sizeof(process_t));
+	process_t *p = (process_t *) slab_alloc(process_cache);
 	if (!p)
 		return NULL;
 	memset(p, 0, sizeof(*p));
 
-	p->kernel_stack_base = mm_alloc(PROCESS_KERNEL_STACK_SIZE);
+	// Sin slots de stack (o sin paginacion propia) se usa un stack comprometido entero
+	p->kernel_stack_base = paging_stack_alloc(PROCESS_KERNEL_STACK_SIZE);
+	if (!p->kernel_stack_base)
+		p->kernel_stack_base = mm_alloc_for(MM_USE_STACKS, PROCESS_KERNEL_STACK_SIZE);
 	if (!p->kernel_stack_base) {
-		mm_free(p);
+		slab_free(process_cache, p);
 		return NULL;
 	}
 	p->kernel_stack_top = (uint8_t *) p->kernel_stack_base + PROCESS_KERNEL_STACK_SIZE;
@@ -103,6 +114,7 @@ process_t *process_create(const char *name, process_entry_point_t entry_point, v
 			fd_entry_t *child_fd = &p->fds[i];
 
 			child_fd->type = parent_fd->type;
+			child_fd->flags = parent_fd->flags;
 
 			if (parent_fd->type == FD_TYPE_PIPE_READ || parent_fd->type == FD_TYPE_PIPE_WRITE) {
 				if (parent_fd->pipe) {
@@ -148,6 +160,13 @@ process_t *process_create(const char *name, process_entry_point_t entry_point, v
 	return p;
 }
 
+void process_set_entry_arg(process_t *p, void *entry_arg) {
+	if (!p || p->state != PROCESS_STATE_READY)
+		return;
+	p->entry_arg = entry_arg;
+	p->rsp = setup_process_context(p->kernel_stack_top, (void *) p->entry_point, entry_arg);
+}
+
 void process_destroy(process_t *p) {
 	if (!p)
 		return;
@@ -164,6 +183,7 @@ void process_destroy(process_t *p) {
 			p->fds[i].type = FD_TYPE_TERMINAL;
 			p->fds[i].pipe = NULL;
 		}
+		p->fds[i].flags = 0;
 	}
 
 	if (p->parent) {
@@ -176,17 +196,24 @@ void process_destroy(process_t *p) {
 		p->parent = p->next_sibling = p->prev_sibling = NULL;
 	}
 
-	if (p->kernel_stack_base)
+	shm_detach_all(p);
+	process_mem_release_all(p);
+	paging_destroy(p);
+
+	if (p->kernel_stack_base && !paging_stack_free(p->kernel_stack_base))
 		mm_free(p->kernel_stack_base);
 	if (p->user_stack_base)
 		mm_free(p->user_stack_base);
-	mm_free(p);
+	slab_free(process_cache, p);
 }
 
 void process_close_fds(process_t *p) {
 	if (!p)
 		return;
 
+	// Un proceso que muere bloqueado en poll no puede quedar anotado en las colas de sus pipes
+	poll_cancel(p);
+
 	for (int i = 0; i < MAX_FDS; i++) {
 		if (p->fds[i].type == FD_TYPE_PIPE_READ || p->fds[i].type == FD_TYPE_PIPE_WRITE) {
 			if (p->fds[i].pipe) {
@@ -199,6 +226,7 @@ void process_close_fds(process_t *p) {
 			p->fds[i].type = FD_TYPE_TERMINAL;
 			p->fds[i].pipe = NULL;
 		}
+		p->fds[i].flags = 0;
 	}
 }
 
@@ -0,0 +1,219 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <lib.h>
+#include <mm.h>
+#include <paging.h>
+#include <process.h>
+#include <slab.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROCESS_MAX_ARGS 64
+
+/*
+ * Cada bloque de memoria de usuario se registra en la lista de su proceso duenio. El registro vive fuera
+ * del bloque (en un slab) para no agregar un header que rompa los tamaños potencia de 2 del buddy.
+ * Los bloques son de paginas enteras: el proceso los ve en su ventana de usuario y el kernel por la identidad.
+ */
+struct process_mem_block {
+	void *base;		 // direccion del kernel
+	void *user_base; // direccion en el espacio del proceso
+	uint64_t size;
+	process_mem_block_t *next;
+	process_mem_block_t *prev;
+};
+
+static slab_cache_t *mem_block_cache = NULL;
+
+void process_memory_init(void) {
+	if (!mem_block_cache)
+		mem_block_cache = slab_cache_create("process_mem_block", sizeof(process_mem_block_t), NULL);
+}
+
+static void unlink_block(process_t *p, process_mem_block_t *b) {
+	if (b->prev)
+		b->prev->next = b->next;
+	else
+		p->mem_blocks = b->next;
+	if (b->next)
+		b->next->prev = b->prev;
+	p->mem_bytes -= b->size;
+	p->mem_block_count--;
+}
+
+// align 0 usa la alineacion de pagina
+static process_mem_block_t *block_alloc(process_t *p, uint64_t size, uint64_t align) {
+	if (!p || size == 0)
+		return NULL;
+	size = (size + MM_PAGE_SIZE - 1) & ~(MM_PAGE_SIZE - 1);
+	if (p->mem_quota && (size > p->mem_quota || p->mem_bytes > p->mem_quota - size))
+		return NULL;
+
+	process_mem_block_t *b = (process_mem_block_t *) slab_alloc(mem_block_cache);
+	if (!b)
+		return NULL;
+	// La memoria de usuario se entrega en cero para no filtrar datos de otros procesos
+	if (align > MM_PAGE_SIZE) {
+		b->base = mm_alloc_aligned_for(MM_USE_USER, size, align);
+		if (b->base)
+			memset(b->base, 0, size);
+	}
+	else {
+		b->base = mm_alloc_zeroed_for(MM_USE_USER, size);
+	}
+	b->user_base = b->base ? paging_map_user(p, b->base, size) : NULL;
+	if (!b->user_base) {
+		if (b->base)
+			mm_free(b->base);
+		slab_free(mem_block_cache, b);
+		return NULL;
+	}
+	b->size = size;
+
+	b->prev = NULL;
+	b->next = p->mem_blocks;
+	if (b->next)
+		b->next->prev = b;
+	p->mem_blocks = b;
+	p->mem_bytes += size;
+	p->mem_block_count++;
+	return b;
+}
+
+void *process_mem_alloc(process_t *p, uint64_t size) {
+	process_mem_block_t *b = block_alloc(p, size, 0);
+	return b ? b->user_base : NULL;
+}
+
+void *process_mem_alloc_aligned(process_t *p, uint64_t size, uint64_t align) {
+	process_mem_block_t *b = block_alloc(p, size, align);
+	return b ? b->user_base : NULL;
+}
+
+// Solo libera bloques del propio proceso; la busqueda es lineal en la cantidad de regiones del proceso
+int process_mem_free(process_t *p, void *ptr) {
+	if (!p || !ptr)
+		return 0;
+
+	for (process_mem_block_t *b = p->mem_blocks; b; b = b->next) {
+		if (b->user_base == ptr) {
+			unlink_block(p, b);
+			paging_unmap_user(p, b->user_base, b->size);
+			mm_free(b->base);
+			slab_free(mem_block_cache, b);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static process_mem_block_t *find_block(process_t *p, void *ptr) {
+	for (process_mem_block_t *b = p->mem_blocks; b; b = b->next) {
+		if (b->user_base == ptr)
+			return b;
+	}
+	return NULL;
+}
+
+// Direccion del kernel del bloque de p que empieza en ptr (y su tamaño), o NULL
+void *process_mem_lookup(process_t *p, void *ptr, uint64_t *size) {
+	if (!p || !ptr)
+		return NULL;
+	process_mem_block_t *b = find_block(p, ptr);
+	if (!b)
+		return NULL;
+	if (size)
+		*size = b->size;
+	return b->base;
+}
+
+// Saca el bloque de p sin liberarlo: deja de verse en su ventana y pasa a ser de quien lo pidio (mm_free)
+int process_mem_detach(process_t *p, void *ptr) {
+	if (!p || !ptr)
+		return 0;
+	process_mem_block_t *b = find_block(p, ptr);
+	if (!b)
+		return 0;
+	unlink_block(p, b);
+	paging_unmap_user(p, b->user_base, b->size);
+	slab_free(mem_block_cache, b);
+	return 1;
+}
+
+void process_mem_release_all(process_t *p) {
+	if (!p)
+		return;
+
+	process_mem_block_t *b = p->mem_blocks;
+	while (b) {
+		process_mem_block_t *next = b->next;
+		mm_free(b->base);
+		slab_free(mem_block_cache, b);
+		b = next;
+	}
+	p->mem_blocks = NULL;
+	p->mem_bytes = 0;
+	p->mem_block_count = 0;
+
+	// Sigue mapeada hasta paging_destroy, pero el proceso ya no vuelve a correr
+	if (p->local_page) {
+		mm_free(p->local_page);
+		p->local_page = NULL;
+	}
+}
+
+// Pagina local de p (se arma la primera vez que se pide); la primera palabra es el ancla del heap de userland
+void *process_mem_local(process_t *p) {
+	if (!p)
+		return NULL;
+	if (p->local_page)
+		return paging_is_enabled() ? (void *) PAGING_LOCAL_PAGE : p->local_page;
+
+	void *page = mm_alloc_zeroed_for(MM_USE_USER, MM_PAGE_SIZE);
+	if (!page)
+		return NULL;
+	void *local = paging_map_local(p, page);
+	if (!local) {
+		mm_free(page);
+		return NULL;
+	}
+	p->local_page = page;
+	return local;
+}
+
+/*
+ * Copia argv (terminado en NULL) a un unico bloque del proceso: el arreglo de punteros seguido de los strings.
+ * Se escribe por la direccion del kernel (p puede no ser el proceso en ejecucion) con punteros de usuario.
+ */
+char **process_copy_argv(process_t *p, char *const argv[]) {
+	if (!p || !argv)
+		return NULL;
+
+	uint64_t argc = 0;
+	uint64_t strings_size = 0;
+	while (argc < PROCESS_MAX_ARGS && argv[argc]) {
+		const char *arg = argv[argc];
+		uint64_t len = 0;
+		while (arg[len] != '\0')
+			len++;
+		strings_size += len + 1;
+		argc++;
+	}
+
+	uint64_t table_size = (argc + 1) * sizeof(char *);
+	process_mem_block_t *b = block_alloc(p, table_size + strings_size, 0);
+	if (!b)
+		return NULL;
+
+	char **copy = (char **) b->base;
+	char *cursor = (char *) copy + table_size;
+	for (uint64_t i = 0; i < argc; i++) {
+		copy[i] = (char *) b->user_base + (cursor - (char *) copy);
+		const char *arg = argv[i];
+		do {
+			*cursor++ = *arg;
+		} while (*arg++ != '\0');
+	}
+	copy[argc] = NULL;
+	return (char **) b->user_base;
+}
@@ -2,6 +2,9 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <interrupts.h>
 #include <keyboardDriver.h>
+#include <mm.h>
+#include <paging.h>
+#include <poll.h>
 #include <process.h>
 #include <scheduler.h>
 #include <stdbool.h>
@@ -21,6 +24,7 @@ static process_queue_t blocked_q;
 static process_queue_t finished_q;
 
 static process_t *current = NULL;
+
 static process_t *idle_p = NULL;
 static uint64_t last_switch_tick = 0;
 
@@ -47,10 +51,13 @@ static process_t *ready_queue_pop_highest(void) {
 	return NULL;
 }
 
+// Solo corre sin otros procesos listos: aprovecha para pre-cerar memoria y duerme cuando no queda nada
 static void idle_entry(void *unused) {
 	(void) unused;
 	for (;;) {
-		_hlt();
+		paging_stack_refill();
+		if (!mm_idle_zero_step() && !mm_idle_trim_step())
+			_hlt();
 	}
 }
 
@@ -74,6 +81,23 @@ static void apply_aging(void) {
 	}
 }
 
+/*
+ * Un proceso en foreground que termina le devuelve el foreground al padre, salvo que el padre este esperando
+ * a otro hijo: en ese caso queda anotado y se lo devuelve syscall_wait cuando el padre lo recoja (asi la shell
+ * no vuelve al foreground mientras quedan etapas de un pipeline corriendo).
+ */
+static int return_foreground(process_t *p) {
+	process_t *parent = p->parent;
+	if (!p->is_foreground || !parent || parent->state == PROCESS_STATE_FINISHED)
+		return 0;
+	if (parent->waiting_on_pid != 0 && parent->waiting_on_pid != p->pid) {
+		parent->foreground_owed_by = p->pid;
+		return 0;
+	}
+	parent->is_foreground = 1;
+	return 1;
+}
+
 static void save_context(process_t *p, uint64_t current_rsp) {
 	if (!p) {
 		return;
@@ -93,8 +117,7 @@ static void save_context(process_t *p, uint64_t current_rsp) {
 			process_queue_push(&blocked_q, p);
 			break;
 		case PROCESS_STATE_FINISHED:
-			if (p->is_foreground && p->parent && p->parent->state != PROCESS_STATE_FINISHED) {
-				p->parent->is_foreground = 1;
+			if (return_foreground(p)) {
 				keyboard_clear_buffer();
 			}
 
@@ -137,6 +160,7 @@ uint64_t schedule(uint64_t current_rsp) {
 	uint64_t now = ticks_elapsed();
 
 	apply_aging();
+	poll_expire(now);
 
 	bool quantum_expired = (now - last_switch_tick) >= QUANTUM_TICKS;
 	bool must_switch = (current->state != PROCESS_STATE_RUNNING);
@@ -157,6 +181,7 @@ uint64_t schedule(uint64_t current_rsp) {
 	}
 
 	need_resched = 0;
+	process_t *prev = current;
 	save_context(current, current_rsp);
 
 	process_t *next = ready_queue_pop_highest();
@@ -172,12 +197,22 @@ uint64_t schedule(uint64_t current_rsp) {
 	}
 
 	current = next;
+	// Antes de destruir terminados: ninguno puede quedar con sus tablas cargadas
+	paging_switch(next);
 	last_switch_tick = now;
 
+	/*
+	 * schedule() todavia corre sobre el stack de kernel de prev: si prev termino, su stack se libera en el
+	 * proximo schedule(), cuando ya no es el stack activo. prev es el ultimo que entro a finished_q.
+	 */
 	for (int i = 0; i < MAX_FINISHED_COLLECT; i++) {
 		process_t *fp = scheduler_collect_finished();
 		if (!fp)
 			break;
+		if (fp == prev) {
+			process_queue_push(&finished_q, fp);
+			break;
+		}
 		process_destroy(fp);
 	}
 	return next->rsp;
@@ -307,9 +342,7 @@ int scheduler_kill_by_pid(uint64_t pid) {
 
 	process_close_fds(p);
 
-	if (p->is_foreground && p->parent && p->parent->state != PROCESS_STATE_FINISHED) {
-		p->parent->is_foreground = 1;
-	}
+	return_foreground(p);
 
 	if (p->state == PROCESS_STATE_READY) {
 		process_queue_remove(&ready_queues[p->priority], p);
@@ -405,6 +438,10 @@ static void add_process_to_list(process_t *p, process_info_t *buffer, uint64_t *
 	buffer[*count].rsp = p->rsp;
 	buffer[*count].rbp = p->rbp;
 	buffer[*count].foreground = p->is_foreground;
+	buffer[*count].mem_bytes = p->mem_bytes;
+	buffer[*count].stack_bytes = paging_stack_resident(p->kernel_stack_base);
+	if (buffer[*count].stack_bytes == 0)
+		buffer[*count].stack_bytes = PROCESS_KERNEL_STACK_SIZE;
 	(*count)++;
 }
 
@@ -473,3 +510,12 @@ uint64_t scheduler_get_foreground_pid(void) {
 
 	return 0;
 }
+
+int scheduler_set_mem_quota(uint64_t pid, uint64_t quota) {
+	process_t *p = scheduler_find_by_pid(pid);
+	if (!p || p == idle_p) {
+		return 0;
+	}
+	p->mem_quota = quota;
+	return 1;
+}
@@ -38,6 +38,24 @@ static SyscallHandler syscallHandlers[] = {
 	(SyscallHandler) syscall_pipe_dup,
 	(SyscallHandler) syscall_pipe_release_fd,
 	(SyscallHandler) syscall_get_foreground_pid,
+	(SyscallHandler) syscall_slab_info,
+	(SyscallHandler) syscall_region_alloc,
+	(SyscallHandler) syscall_region_free,
+	(SyscallHandler) syscall_user_heap_slot,
+	(SyscallHandler) syscall_set_mem_quota,
+	(SyscallHandler) syscall_region_alloc_aligned,
+	(SyscallHandler) syscall_mem_profile,
+	(SyscallHandler) syscall_shm_create,
+	(SyscallHandler) syscall_shm_attach,
+	(SyscallHandler) syscall_shm_detach,
+	(SyscallHandler) syscall_heap_info,
+	(SyscallHandler) syscall_set_heap_use,
+	(SyscallHandler) syscall_paging_ctl,
+	(SyscallHandler) syscall_pipe_set_size,
+	(SyscallHandler) syscall_pipe_splice,
+	(SyscallHandler) syscall_pipe_gift,
+	(SyscallHandler) syscall_poll,
+	(SyscallHandler) syscall_fcntl,
 };
 
 #define SYSCALLS_COUNT (sizeof(syscallHandlers) / sizeof(syscallHandlers[0]))
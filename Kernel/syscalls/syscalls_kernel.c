@@ -3,10 +3,15 @@
 #include <interrupts.h>
 #include <keyboardDriver.h>
 #include <mm.h>
+#include <mm_profile.h>
+#include <paging.h>
 #include <pipe.h>
+#include <poll.h>
 #include <process.h>
 #include <scheduler.h>
 #include <semaphore.h>
+#include <shm.h>
+#include <slab.h>
 #include <stddef.h>
 #include <string.h>
 #include <syscalls_lib.h>
@@ -27,6 +32,7 @@ uint64_t syscall_read(int fd, char *buffer, int count) {
 	}
 
 	fd_entry_t *fd_entry = &current_process->fds[fd];
+	int nonblock = (fd_entry->flags & O_NONBLOCK) != 0;
 
 	if (fd_entry->type == FD_TYPE_TERMINAL) {
 		if (fd != STDIN) {
@@ -34,6 +40,9 @@ uint64_t syscall_read(int fd, char *buffer, int count) {
 		}
 
 		if (!current_process->is_foreground) {
+			if (nonblock) {
+				return FD_WOULD_BLOCK;
+			}
 			scheduler_block_by_pid(current_process->pid);
 			return 0;
 		}
@@ -42,6 +51,10 @@ uint64_t syscall_read(int fd, char *buffer, int count) {
 		while (read < (uint64_t) count) {
 			char c = keyboard_read_getchar();
 			if (c == 0) {
+				// Sin bloquear se devuelve lo que ya estaba en el buffer
+				if (nonblock) {
+					return read ? read : FD_WOULD_BLOCK;
+				}
 				keyboard_wait_for_char();
 				continue;
 			}
@@ -60,7 +73,8 @@ uint64_t syscall_read(int fd, char *buffer, int count) {
 		if (!fd_entry->pipe) {
 			return 0;
 		}
-		return pipe_read(fd_entry->pipe, buffer, count);
+		int n = pipe_read(fd_entry->pipe, buffer, count, nonblock);
+		return (n == PIPE_WOULD_BLOCK) ? FD_WOULD_BLOCK : (uint64_t) n;
 	}
 	else {
 		return 0;
@@ -94,7 +108,8 @@ uint64_t syscall_write(int fd, const char *buffer, int count) {
 		if (!fd_entry->pipe) {
 			return 0;
 		}
-		return pipe_write(fd_entry->pipe, buffer, count);
+		int n = pipe_write(fd_entry->pipe, buffer, count, (fd_entry->flags & O_NONBLOCK) != 0);
+		return (n == PIPE_WOULD_BLOCK) ? FD_WOULD_BLOCK : (uint64_t) n;
 	}
 	else {
 		return 0;
@@ -107,9 +122,8 @@ uint64_t syscall_clearScreen() {
 }
 
 uint64_t syscall_sleep(int duration) {
-	const uint32_t HZ = 18;
 	uint64_t start = ticks_elapsed();
-	uint64_t wait_tics = (duration * HZ + 999) / 1000;
+	uint64_t wait_tics = (duration * TIMER_HZ + 999) / 1000;
 	uint64_t target = start + wait_tics;
 
 	while (ticks_elapsed() < target) {
@@ -144,19 +158,42 @@ uint64_t syscall_get_screen_dimensions(uint64_t *width, uint64_t *height) {
 	return 1;
 }
 uint64_t syscall_malloc(uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	return syscall_region_alloc(size, 0, 0, 0, 0);
+}
+
+uint64_t syscall_free(uint64_t address, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	return syscall_region_free(address, 0, 0, 0, 0);
+}
+
+uint64_t syscall_region_alloc(uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
 	if (size == 0) {
 		return 0;
 	}
-	void *ptr = mm_alloc(size);
-	return (uint64_t) ptr;
+	return (uint64_t) process_mem_alloc(scheduler_current_process(), size);
 }
 
-uint64_t syscall_free(uint64_t address, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+uint64_t syscall_region_free(uint64_t address, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
 	if (address == 0) {
 		return 0;
 	}
-	mm_free((void *) address);
-	return 1;
+	return process_mem_free(scheduler_current_process(), (void *) address);
+}
+
+uint64_t syscall_region_alloc_aligned(uint64_t size, uint64_t align, uint64_t unused2, uint64_t unused3,
+									  uint64_t unused4) {
+	if (size == 0 || align == 0 || (align & (align - 1)) || align > MM_MAX_ALIGN) {
+		return 0;
+	}
+	return (uint64_t) process_mem_alloc_aligned(scheduler_current_process(), size, align);
+}
+
+uint64_t syscall_set_mem_quota(uint64_t pid, uint64_t quota, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	return scheduler_set_mem_quota(pid, quota);
+}
+
+uint64_t syscall_user_heap_slot(uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4,
+								uint64_t unused5) {
+	return (uint64_t) process_mem_local(scheduler_current_process());
 }
 
 uint64_t syscall_meminfo(uint64_t user_addr, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
@@ -179,9 +216,10 @@ uint64_t syscall_create_process(char *name, void *function, char *argv[], uint64
 		is_foreground = (int) is_foreground_and_pipes;
 	}
 	else {
-		stdin_pipe_id = is_foreground_and_pipes & 0xFFFF;
-		stdout_pipe_id = (is_foreground_and_pipes >> 16) & 0xFFFF;
-		is_foreground = (is_foreground_and_pipes >> 32) & 0x1;
+		// Dos ids de pipe de PIPE_ID_BITS, el bit de foreground y el bit que marca este formato
+		stdin_pipe_id = is_foreground_and_pipes & PIPE_ID_MASK;
+		stdout_pipe_id = (is_foreground_and_pipes >> PIPE_ID_BITS) & PIPE_ID_MASK;
+		is_foreground = (is_foreground_and_pipes >> (2 * PIPE_ID_BITS)) & 0x1;
 	}
 
 	process_t *parent = scheduler_current_process();
@@ -200,6 +238,16 @@ uint64_t syscall_create_process(char *name, void *function, char *argv[], uint64
 		}
 		return 0;
 	}
+
+	// El hijo recibe su propia copia de argv: el padre puede liberar la suya o terminar sin dejarla colgando
+	if (argv) {
+		char **argv_copy = process_copy_argv(p, argv);
+		if (!argv_copy) {
+			scheduler_kill_by_pid(p->pid);
+			return 0;
+		}
+		process_set_entry_arg(p, argv_copy);
+	}
 	return p->pid;
 }
 
@@ -237,6 +285,12 @@ uint64_t syscall_set_priority(uint64_t pid, uint64_t newPrio, uint64_t unused2,
 uint64_t syscall_wait(uint64_t pid, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
 	if ((int64_t) pid <= 0)
 		return 0;
+	// El hijo pudo haberse destruido ya: el foreground que dejo pendiente se devuelve igual
+	process_t *caller = scheduler_current_process();
+	if (caller && caller->foreground_owed_by == pid) {
+		caller->foreground_owed_by = 0;
+		caller->is_foreground = 1;
+	}
 	process_t *target = scheduler_find_by_pid(pid);
 	if (!target)
 		return 0;
@@ -404,6 +458,7 @@ uint64_t syscall_pipe_dup(uint64_t pipe_id, uint64_t fd, uint64_t mode, uint64_t
 	}
 
 	entry->pipe = pipe;
+	entry->flags = 0;
 
 	return 1;
 }
@@ -430,6 +485,7 @@ uint64_t syscall_pipe_release_fd(uint64_t fd, uint64_t unused1, uint64_t unused2
 	}
 	entry->type = FD_TYPE_TERMINAL;
 	entry->pipe = NULL;
+	entry->flags = 0;
 	return 1;
 }
 
@@ -437,3 +493,151 @@ uint64_t syscall_get_foreground_pid(uint64_t unused1, uint64_t unused2, uint64_t
 									uint64_t unused5) {
 	return scheduler_get_foreground_pid();
 }
+
+uint64_t syscall_slab_info(uint64_t user_addr, uint64_t max_count, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	if (user_addr == 0 || max_count == 0 || max_count > MAX_SLAB_CACHES) {
+		return 0;
+	}
+	return slab_get_info((slab_info_t *) user_addr, max_count);
+}
+
+uint64_t syscall_mem_profile(uint64_t cmd, uint64_t user_addr, uint64_t max_count, uint64_t unused1, uint64_t unused2) {
+	switch (cmd) {
+		case MM_PROF_CMD_STATUS:
+			if (user_addr == 0)
+				return 0;
+			mm_profile_status((mm_prof_status_t *) user_addr);
+			return 1;
+		case MM_PROF_CMD_SITES:
+			if (user_addr == 0 || max_count == 0 || max_count > MM_PROF_MAX_SITES)
+				return 0;
+			return mm_profile_top_sites((mm_prof_site_t *) user_addr, max_count);
+		case MM_PROF_CMD_EVENTS:
+			if (user_addr == 0 || max_count == 0 || max_count > MM_PROF_RING_SIZE)
+				return 0;
+			return mm_profile_recent_events((mm_prof_event_t *) user_addr, max_count);
+		case MM_PROF_CMD_ENABLE:
+			mm_profile_enable();
+			return 1;
+		case MM_PROF_CMD_DISABLE:
+			mm_profile_disable();
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+uint64_t syscall_shm_create(uint64_t name, uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3) {
+	if (name == 0 || size == 0) {
+		return 0;
+	}
+	return (uint64_t) shm_create(scheduler_current_process(), (const char *) name, size);
+}
+
+uint64_t syscall_shm_attach(uint64_t name, uint64_t size_out, uint64_t unused1, uint64_t unused2, uint64_t unused3) {
+	if (name == 0) {
+		return 0;
+	}
+	return (uint64_t) shm_attach(scheduler_current_process(), (const char *) name, (uint64_t *) size_out);
+}
+
+uint64_t syscall_shm_detach(uint64_t address, uint64_t unused1, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	return shm_detach(scheduler_current_process(), (void *) address);
+}
+
+uint64_t syscall_heap_info(uint64_t user_addr, uint64_t max_count, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	if (user_addr == 0 || max_count == 0 || max_count > MM_MAX_HEAPS) {
+		return 0;
+	}
+	return mm_get_heap_info((mm_heap_info_t *) user_addr, max_count);
+}
+
+uint64_t syscall_set_heap_use(uint64_t use, uint64_t heap, uint64_t unused2, uint64_t unused3, uint64_t unused4) {
+	if (use >= MM_USE_COUNT || heap >= MM_MAX_HEAPS) {
+		return 0;
+	}
+	return mm_set_use_heap((mm_use_t) use, (int) heap);
+}
+
+uint64_t syscall_paging_ctl(uint64_t cmd, uint64_t user_addr, uint64_t unused1, uint64_t unused2, uint64_t unused3) {
+	switch (cmd) {
+		case PAGING_CMD_STATUS:
+			if (user_addr == 0)
+				return 0;
+			paging_get_stats((paging_stats_t *) user_addr);
+			return 1;
+		case PAGING_CMD_PCID_ON:
+			return paging_set_pcid(1);
+		case PAGING_CMD_PCID_OFF:
+			return paging_set_pcid(0);
+		default:
+			return 0;
+	}
+}
+
+// size 0 consulta la capacidad actual
+uint64_t syscall_pipe_set_size(uint64_t pipe_id, uint64_t size, uint64_t unused1, uint64_t unused2, uint64_t unused3) {
+	return pipe_set_size(pipe_id, size);
+}
+
+// Mueve datos del pipe de lectura fd_in al de escritura fd_out sin pasar por userland
+uint64_t syscall_pipe_splice(uint64_t fd_in, uint64_t fd_out, uint64_t count, uint64_t unused1, uint64_t unused2) {
+	process_t *p = scheduler_current_process();
+	if (!p || fd_in >= MAX_FDS || fd_out >= MAX_FDS || count == 0) {
+		return 0;
+	}
+	fd_entry_t *in = &p->fds[fd_in];
+	fd_entry_t *out = &p->fds[fd_out];
+	if (in->type != FD_TYPE_PIPE_READ || !in->pipe || out->type != FD_TYPE_PIPE_WRITE || !out->pipe) {
+		return 0;
+	}
+	return pipe_splice(in->pipe, out->pipe, count);
+}
+
+/*
+ * Regala al pipe de fd los primeros length bytes de la region que empieza en address (de sys_region_alloc).
+ * Si sale bien la region deja de ser del proceso; si devuelve 0 sigue siendo suya.
+ */
+uint64_t syscall_pipe_gift(uint64_t fd, uint64_t address, uint64_t length, uint64_t unused1, uint64_t unused2) {
+	process_t *p = scheduler_current_process();
+	if (!p || fd >= MAX_FDS || length == 0) {
+		return 0;
+	}
+	fd_entry_t *entry = &p->fds[fd];
+	if (entry->type != FD_TYPE_PIPE_WRITE || !entry->pipe) {
+		return 0;
+	}
+	uint64_t size = 0;
+	void *base = process_mem_lookup(p, (void *) address, &size);
+	if (!base || length > size) {
+		return 0;
+	}
+	// pipe_gift puede bloquear, pero una vez encolado el bloque se desliga sin volver a ceder la CPU
+	if (!pipe_gift(entry->pipe, base, length)) {
+		return 0;
+	}
+	process_mem_detach(p, (void *) address);
+	return length;
+}
+
+// Devuelve cuantos fds tienen eventos, 0 si vencio timeout_ms (negativo = sin limite) o -1 si falla
+uint64_t syscall_poll(uint64_t fds, uint64_t count, uint64_t timeout_ms, uint64_t unused1, uint64_t unused2) {
+	return (uint64_t) poll_wait((poll_fd_t *) fds, count, (int64_t) timeout_ms);
+}
+
+// F_GETFL devuelve los flags del fd y F_SETFL los reemplaza (solo se guarda O_NONBLOCK); -1 si fd o cmd no son validos
+uint64_t syscall_fcntl(uint64_t fd, uint64_t cmd, uint64_t flags, uint64_t unused1, uint64_t unused2) {
+	process_t *p = scheduler_current_process();
+	if (!p || fd >= MAX_FDS) {
+		return (uint64_t) -1;
+	}
+	fd_entry_t *entry = &p->fds[fd];
+	if (cmd == F_GETFL) {
+		return entry->flags;
+	}
+	if (cmd == F_SETFL) {
+		entry->flags = (uint32_t) (flags & O_NONBLOCK);
+		return 0;
+	}
+	return (uint64_t) -1;
+}
@@ -13,5 +13,5 @@ int ticks_elapsed() {
 }
 
 int seconds_elapsed() {
-	return ticks / 18;
+	return ticks / TIMER_HZ;
 }
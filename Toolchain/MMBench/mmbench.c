@@ -0,0 +1,464 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#define _GNU_SOURCE
+#include <math.h>
+#include <mm.h>
+#include <mm_backend.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Reproduce trazas de alloc/free contra el memory manager elegido al compilar (MM=) y mide ops/s,
+ * latencias p50/p99, pico de memoria y fragmentacion. La traza sale de un archivo (-t) o de una carga
+ * sintetica (-w) que tambien se puede grabar (-o) para repetirla despues con exactamente los mismos pedidos.
+ *
+ * Formato de traza, una operacion por linea:
+ *   a <id> <bytes>   pide un bloque y lo guarda en el slot id
+ *   f <id>           libera el bloque del slot id
+ */
+
+#define DEFAULT_OPS 1000000
+#define DEFAULT_HEAP_MB 256
+#define DEFAULT_SLOTS 8192
+#define MAX_SLOTS (1 << 20)
+#define PRODCONS_DEPTH 1024
+#define CHURN_PROCESSES 32
+#define CHURN_OBJECTS 48
+#define CHURN_STACK_SIZE (16 * 1024)
+#define CHURN_REGION_SIZE (64 * 1024)
+#define PROCS_PER_ROUND 32
+#define PROCS_PAGES 6
+#define PROCS_OBJECTS 4
+#define PROCS_PAGE_SIZE 4096
+
+typedef struct {
+	uint8_t free;
+	uint32_t slot;
+	uint64_t size;
+} trace_op_t;
+
+typedef struct {
+	trace_op_t *ops;
+	uint64_t count;
+	uint64_t capacity;
+	uint32_t slots;
+} trace_t;
+
+typedef struct {
+	const char *workload;
+	const char *trace_in;
+	const char *trace_out;
+	uint64_t ops;
+	uint64_t heap_bytes;
+	uint32_t seed;
+	int raw;
+} options_t;
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+static uint64_t rng_next(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return rng_state;
+}
+
+static uint64_t rng_range(uint64_t lo, uint64_t hi) {
+	return lo + rng_next() % (hi - lo + 1);
+}
+
+static double rng_unit(void) {
+	return (double) (rng_next() >> 11) / (double) (1ULL << 53);
+}
+
+static void trace_push(trace_t *t, int is_free, uint32_t slot, uint64_t size) {
+	if (t->count == t->capacity) {
+		t->capacity = t->capacity ? t->capacity * 2 : 4096;
+		t->ops = realloc(t->ops, t->capacity * sizeof(trace_op_t));
+		if (!t->ops) {
+			fprintf(stderr, "mmbench: sin memoria para la traza\n");
+			exit(1);
+		}
+	}
+	t->ops[t->count].free = (uint8_t) is_free;
+	t->ops[t->count].slot = slot;
+	t->ops[t->count].size = size;
+	t->count++;
+	if (slot + 1 > t->slots)
+		t->slots = slot + 1;
+}
+
+// Tamaños uniformes entre 16 B y 4 KB sobre un conjunto de slots que se llenan y vacian al azar
+static void gen_uniform(trace_t *t, uint64_t ops) {
+	uint8_t *live = calloc(DEFAULT_SLOTS, 1);
+	while (t->count < ops) {
+		uint32_t slot = (uint32_t) rng_range(0, DEFAULT_SLOTS - 1);
+		if (live[slot])
+			trace_push(t, 1, slot, 0);
+		else
+			trace_push(t, 0, slot, rng_range(16, 4096));
+		live[slot] ^= 1;
+	}
+	free(live);
+}
+
+// Pareto (alpha 1.2) desde 16 B y acotada a 1 MB: muchos pedidos chicos y pocos muy grandes
+static uint64_t powerlaw_size(void) {
+	double u = rng_unit();
+	if (u < 1e-9)
+		u = 1e-9;
+	double size = 16.0 / pow(u, 1.0 / 1.2);
+	return (size > 1024.0 * 1024.0) ? 1024 * 1024 : (uint64_t) size;
+}
+
+static void gen_powerlaw(trace_t *t, uint64_t ops) {
+	uint8_t *live = calloc(DEFAULT_SLOTS, 1);
+	while (t->count < ops) {
+		uint32_t slot = (uint32_t) rng_range(0, DEFAULT_SLOTS - 1);
+		if (live[slot])
+			trace_push(t, 1, slot, 0);
+		else
+			trace_push(t, 0, slot, powerlaw_size());
+		live[slot] ^= 1;
+	}
+	free(live);
+}
+
+// Cola FIFO como la de un pipe: el productor pide y el consumidor libera el bloque mas viejo
+static void gen_prodcons(trace_t *t, uint64_t ops) {
+	uint32_t head = 0;
+	uint32_t tail = 0;
+	while (t->count < ops) {
+		if (head - tail < PRODCONS_DEPTH && (head == tail || rng_next() % 2)) {
+			trace_push(t, 0, head % PRODCONS_DEPTH, rng_range(64, 2048));
+			head++;
+		}
+		else {
+			trace_push(t, 1, tail % PRODCONS_DEPTH, 0);
+			tail++;
+		}
+	}
+}
+
+/*
+ * Procesos que nacen (stack de kernel + region de heap de usuario), hacen pedidos chicos y mueren
+ * liberando todo junto, como process_create/process_destroy.
+ */
+static void gen_churn(trace_t *t, uint64_t ops) {
+	const uint32_t per_process = CHURN_OBJECTS + 2;
+	uint8_t alive[CHURN_PROCESSES] = {0};
+	uint8_t objects[CHURN_PROCESSES][CHURN_OBJECTS] = {{0}};
+
+	while (t->count < ops) {
+		uint32_t p = (uint32_t) rng_range(0, CHURN_PROCESSES - 1);
+		uint32_t base = p * per_process;
+		if (!alive[p]) {
+			trace_push(t, 0, base, CHURN_STACK_SIZE);
+			trace_push(t, 0, base + 1, CHURN_REGION_SIZE);
+			alive[p] = 1;
+		}
+		else if (rng_next() % 16 == 0) {
+			for (uint32_t o = 0; o < CHURN_OBJECTS; o++) {
+				if (objects[p][o]) {
+					trace_push(t, 1, base + 2 + o, 0);
+					objects[p][o] = 0;
+				}
+			}
+			trace_push(t, 1, base + 1, 0);
+			trace_push(t, 1, base, 0);
+			alive[p] = 0;
+		}
+		else {
+			uint32_t o = (uint32_t) rng_range(0, CHURN_OBJECTS - 1);
+			if (objects[p][o])
+				trace_push(t, 1, base + 2 + o, 0);
+			else
+				trace_push(t, 0, base + 2 + o, rng_range(32, 512));
+			objects[p][o] ^= 1;
+		}
+	}
+}
+
+/*
+ * Rondas de test_processes: nacen PROCS_PER_ROUND procesos (paginas de stack y de argv/heap de usuario mas
+ * algunos objetos chicos) y despues se matan todos en orden aleatorio, liberando sus bloques.
+ */
+static void gen_procs(trace_t *t, uint64_t ops) {
+	const uint32_t per_process = PROCS_PAGES + PROCS_OBJECTS;
+	uint32_t order[PROCS_PER_ROUND];
+
+	while (t->count < ops) {
+		for (uint32_t p = 0; p < PROCS_PER_ROUND; p++) {
+			for (uint32_t i = 0; i < PROCS_PAGES; i++)
+				trace_push(t, 0, p * per_process + i, PROCS_PAGE_SIZE);
+			for (uint32_t i = 0; i < PROCS_OBJECTS; i++)
+				trace_push(t, 0, p * per_process + PROCS_PAGES + i, rng_range(32, 256));
+			order[p] = p;
+		}
+		for (uint32_t i = PROCS_PER_ROUND - 1; i > 0; i--) {
+			uint32_t j = (uint32_t) rng_range(0, i);
+			uint32_t tmp = order[i];
+			order[i] = order[j];
+			order[j] = tmp;
+		}
+		for (uint32_t k = 0; k < PROCS_PER_ROUND; k++) {
+			for (uint32_t i = 0; i < per_process; i++)
+				trace_push(t, 1, order[k] * per_process + i, 0);
+		}
+	}
+}
+
+static int load_trace(trace_t *t, const char *path) {
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	char kind;
+	unsigned long slot;
+	unsigned long long size;
+	int line = 0;
+	while (fscanf(f, " %c %lu", &kind, &slot) == 2) {
+		line++;
+		if (slot >= MAX_SLOTS) {
+			fprintf(stderr, "%s:%d: slot fuera de rango\n", path, line);
+			fclose(f);
+			return 0;
+		}
+		if (kind == 'a' && fscanf(f, " %llu", &size) == 1) {
+			trace_push(t, 0, (uint32_t) slot, size);
+		}
+		else if (kind == 'f') {
+			trace_push(t, 1, (uint32_t) slot, 0);
+		}
+		else {
+			fprintf(stderr, "%s:%d: operacion invalida\n", path, line);
+			fclose(f);
+			return 0;
+		}
+	}
+	fclose(f);
+	return 1;
+}
+
+static int save_trace(const trace_t *t, const char *path) {
+	FILE *f = fopen(path, "w");
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	for (uint64_t i = 0; i < t->count; i++) {
+		if (t->ops[i].free)
+			fprintf(f, "f %u\n", t->ops[i].slot);
+		else
+			fprintf(f, "a %u %llu\n", t->ops[i].slot, (unsigned long long) t->ops[i].size);
+	}
+	fclose(f);
+	return 1;
+}
+
+static inline uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr,
+			"uso: %s [-w uniform|powerlaw|prodcons|churn|procs] [-t traza] [-o traza_salida]\n"
+			"          [-n operaciones] [-m heap_MB] [-s semilla] [-r]\n"
+			"  -r  llama directo al backend, sin la capa de magazines\n",
+			prog);
+}
+
+static int parse_options(int argc, char **argv, options_t *opt) {
+	opt->workload = "uniform";
+	opt->trace_in = NULL;
+	opt->trace_out = NULL;
+	opt->ops = DEFAULT_OPS;
+	opt->heap_bytes = (uint64_t) DEFAULT_HEAP_MB << 20;
+	opt->seed = 1;
+	opt->raw = 0;
+
+	int c;
+	while ((c = getopt(argc, argv, "w:t:o:n:m:s:rh")) != -1) {
+		switch (c) {
+			case 'w':
+				opt->workload = optarg;
+				break;
+			case 't':
+				opt->trace_in = optarg;
+				break;
+			case 'o':
+				opt->trace_out = optarg;
+				break;
+			case 'n':
+				opt->ops = strtoull(optarg, NULL, 10);
+				break;
+			case 'm':
+				opt->heap_bytes = strtoull(optarg, NULL, 10) << 20;
+				break;
+			case 's':
+				opt->seed = (uint32_t) strtoul(optarg, NULL, 10);
+				break;
+			case 'r':
+				opt->raw = 1;
+				break;
+			default:
+				return 0;
+		}
+	}
+	return opt->ops > 0 && opt->heap_bytes > 0;
+}
+
+static int build_trace(trace_t *t, const options_t *opt) {
+	if (opt->trace_in)
+		return load_trace(t, opt->trace_in);
+
+	rng_state ^= (uint64_t) opt->seed * 0x9E3779B97F4A7C15ULL;
+	if (strcmp(opt->workload, "uniform") == 0)
+		gen_uniform(t, opt->ops);
+	else if (strcmp(opt->workload, "powerlaw") == 0)
+		gen_powerlaw(t, opt->ops);
+	else if (strcmp(opt->workload, "prodcons") == 0)
+		gen_prodcons(t, opt->ops);
+	else if (strcmp(opt->workload, "churn") == 0)
+		gen_churn(t, opt->ops);
+	else if (strcmp(opt->workload, "procs") == 0)
+		gen_procs(t, opt->ops);
+	else
+		return 0;
+	return 1;
+}
+
+int main(int argc, char **argv) {
+	options_t opt;
+	if (!parse_options(argc, argv, &opt)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	trace_t trace = {0};
+	if (!build_trace(&trace, &opt)) {
+		usage(argv[0]);
+		return 1;
+	}
+	if (opt.trace_out && !save_trace(&trace, opt.trace_out))
+		return 1;
+
+	uint8_t *heap = aligned_alloc(MM_LARGE_PAGE_SIZE, opt.heap_bytes);
+	void **slots = calloc(trace.slots ? trace.slots : 1, sizeof(void *));
+	uint64_t *slot_sizes = calloc(trace.slots ? trace.slots : 1, sizeof(uint64_t));
+	uint32_t *latencies = malloc(trace.count * sizeof(uint32_t));
+	if (!heap || !slots || !slot_sizes || !latencies) {
+		fprintf(stderr, "mmbench: no se pudo reservar el heap de prueba\n");
+		return 1;
+	}
+	// Se tocan todas las paginas antes de medir para no contar page faults del host
+	memset(heap, 0, opt.heap_bytes);
+	mm_init(heap, opt.heap_bytes);
+	const mm_allocator_t *backend = mm_heap_allocator(0);
+
+	mm_stats_t stats;
+	uint64_t live_bytes = 0;
+	uint64_t peak_live = 0;
+	uint64_t lowest_start = UINT64_MAX;
+	uint64_t highest_end = 0;
+	uint64_t failed = 0;
+	uint64_t skipped = 0;
+	uint64_t measured = 0;
+	double worst_ext_frag = 0.0;
+
+	uint64_t start = now_ns();
+	for (uint64_t i = 0; i < trace.count; i++) {
+		const trace_op_t *op = &trace.ops[i];
+		uint64_t t0 = now_ns();
+		if (op->free) {
+			if (!slots[op->slot]) {
+				skipped++;
+				continue;
+			}
+			if (opt.raw)
+				backend->free(slots[op->slot]);
+			else
+				mm_free(slots[op->slot]);
+			slots[op->slot] = NULL;
+			live_bytes -= slot_sizes[op->slot];
+		}
+		else {
+			if (slots[op->slot]) {
+				skipped++;
+				continue;
+			}
+			void *ptr = opt.raw ? backend->alloc(op->size) : mm_alloc(op->size);
+			if (!ptr) {
+				failed++;
+				latencies[measured++] = (uint32_t) (now_ns() - t0);
+				continue;
+			}
+			slots[op->slot] = ptr;
+			slot_sizes[op->slot] = op->size;
+			live_bytes += op->size;
+			// Huella: rango de direcciones que llego a tocar el backend (buddy reparte desde el final de la arena)
+			uint64_t offset = (uint64_t) ((uint8_t *) ptr - heap);
+			if (offset < lowest_start)
+				lowest_start = offset;
+			if (offset + op->size > highest_end)
+				highest_end = offset + op->size;
+		}
+		uint64_t elapsed = now_ns() - t0;
+		latencies[measured++] = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t) elapsed;
+
+		if (live_bytes > peak_live) {
+			peak_live = live_bytes;
+			// La fragmentacion externa se mide en los picos, que es cuando importa
+			if (opt.raw)
+				backend->get_stats(&stats);
+			else
+				mm_get_stats(&stats);
+			if (stats.free_bytes > 0) {
+				double frag = 1.0 - (double) stats.largest_free_block / (double) stats.free_bytes;
+				if (frag > worst_ext_frag)
+					worst_ext_frag = frag;
+			}
+		}
+	}
+	uint64_t total_ns = now_ns() - start;
+
+	if (opt.raw)
+		backend->get_stats(&stats);
+	else
+		mm_get_stats(&stats);
+
+	uint64_t footprint = (highest_end > lowest_start) ? highest_end - lowest_start : 0;
+
+	// Las operaciones salteadas (free de un slot vacio o alloc sobre uno ocupado) no se miden
+	qsort(latencies, measured, sizeof(uint32_t), cmp_u32);
+	uint64_t ops_done = trace.count - skipped;
+
+	printf("%-6s %-5s %-9s ops=%llu ops/s=%.0f p50=%uns p99=%uns peak_live=%lluKB peak_footprint=%lluKB "
+		   "failed=%llu ext_frag=%.1f%% int_frag=%lluKB splits=%llu merges=%llu\n",
+		   mm_get_manager_name(), opt.raw ? "raw" : "mm", opt.trace_in ? "trace" : opt.workload,
+		   (unsigned long long) ops_done, total_ns ? (double) ops_done * 1e9 / (double) total_ns : 0.0,
+		   measured ? latencies[measured / 2] : 0, measured ? latencies[(measured * 99) / 100] : 0,
+		   (unsigned long long) (peak_live >> 10), (unsigned long long) (footprint >> 10), (unsigned long long) failed,
+		   worst_ext_frag * 100.0, (unsigned long long) (stats.internal_fragmentation >> 10),
+		   (unsigned long long) stats.split_ops, (unsigned long long) stats.merge_ops);
+
+	free(latencies);
+	free(slot_sizes);
+	free(slots);
+	free(trace.ops);
+	free(heap);
+	return 0;
+}
@@ -3,3 +3,11 @@ global _invalidOp
 _invalidOp:
     ud2         ; Instrucción ilegal para generar una excepción de opcode inválido
     
+
+global read_tsc
+
+read_tsc:
+    rdtsc               ; edx:eax = contador de ciclos
+    shl rdx, 32
+    or rax, rdx
+    ret
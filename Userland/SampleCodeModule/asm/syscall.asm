@@ -33,6 +33,24 @@ GLOBAL sys_pipe_close
 GLOBAL sys_pipe_dup
 GLOBAL sys_pipe_release_fd
 GLOBAL sys_get_foreground_pid
+GLOBAL sys_slab_info
+GLOBAL sys_region_alloc
+GLOBAL sys_region_free
+GLOBAL sys_user_heap_slot
+GLOBAL sys_set_mem_quota
+GLOBAL sys_region_alloc_aligned
+GLOBAL sys_mem_profile
+GLOBAL sys_shm_create
+GLOBAL sys_shm_attach
+GLOBAL sys_shm_detach
+GLOBAL sys_heap_info
+GLOBAL sys_set_heap_use
+GLOBAL sys_paging_ctl
+GLOBAL sys_pipe_set_size
+GLOBAL sys_pipe_splice
+GLOBAL sys_pipe_gift
+GLOBAL sys_poll
+GLOBAL sys_fcntl
 
 
 sys_read:
@@ -330,3 +348,165 @@ sys_get_foreground_pid:
     mov rsp, rbp
     pop rbp
     ret
+
+sys_slab_info:
+    push rbp
+    mov rbp, rsp
+    mov rax, 33
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_region_alloc:
+    push rbp
+    mov rbp, rsp
+    mov rax, 34
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_region_free:
+    push rbp
+    mov rbp, rsp
+    mov rax, 35
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_user_heap_slot:
+    push rbp
+    mov rbp, rsp
+    mov rax, 36
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_set_mem_quota:
+    push rbp
+    mov rbp, rsp
+    mov rax, 37
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_region_alloc_aligned:
+    push rbp
+    mov rbp, rsp
+    mov rax, 38
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_mem_profile:
+    push rbp
+    mov rbp, rsp
+    mov rax, 39
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_shm_create:
+    push rbp
+    mov rbp, rsp
+    mov rax, 40
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_shm_attach:
+    push rbp
+    mov rbp, rsp
+    mov rax, 41
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_shm_detach:
+    push rbp
+    mov rbp, rsp
+    mov rax, 42
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_heap_info:
+    push rbp
+    mov rbp, rsp
+    mov rax, 43
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_set_heap_use:
+    push rbp
+    mov rbp, rsp
+    mov rax, 44
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_paging_ctl:
+    push rbp
+    mov rbp, rsp
+    mov rax, 45
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_pipe_set_size:
+    push rbp
+    mov rbp, rsp
+    mov rax, 46
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_pipe_splice:
+    push rbp
+    mov rbp, rsp
+    mov rax, 47
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_pipe_gift:
+    push rbp
+    mov rbp, rsp
+    mov rax, 48
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_poll:
+    push rbp
+    mov rbp, rsp
+    mov rax, 49
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
+
+sys_fcntl:
+    push rbp
+    mov rbp, rsp
+    mov rax, 50
+    int 0x80
+    mov rsp, rbp
+    pop rbp
+    ret
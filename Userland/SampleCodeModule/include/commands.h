@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #define MAX_ARGS 32
+#define MAX_PIPELINE_STAGES 16
 #define OK 0
 #define ERROR -1
 #define EXIT_CODE 1
@@ -29,6 +30,10 @@ int clearCmd(int argc, char *argv[]);
 int exceptionCmd(int argc, char *argv[]);
 int killCmd(int argc, char *argv[]);
 int niceCmd(int argc, char *argv[]);
+int quotaCmd(int argc, char *argv[]);
+int memprofCmd(int argc, char *argv[]);
+int mmheapCmd(int argc, char *argv[]);
+int pagingCmd(int argc, char *argv[]);
 int blockCmd(int argc, char *argv[]);
 
 //Comandos Tests
@@ -37,12 +42,19 @@ int testProcesesCmd(int argc, char *argv[]);
 int testPriorityCmd(int argc, char *argv[]);
 int testSyncCmd(int argc, char *argv[]);
 int testNoSynchroCmd(int argc, char *argv[]);
+int testCtxswCmd(int argc, char *argv[]);
+int testStacksCmd(int argc, char *argv[]);
+int testPipeCmd(int argc, char *argv[]);
+int testSpliceCmd(int argc, char *argv[]);
+int testPollCmd(int argc, char *argv[]);
+int testNonblockCmd(int argc, char *argv[]);
 
 //Comandos Sistema
 int psCmd(int argc, char *argv[]);
 int loopCmd(int argc, char *argv[]);
 int memCmd(int argc, char *argv[]);
 int mmTypeCmd(int argc, char *argv[]);
+int slabinfoCmd(int argc, char *argv[]);
 int catCmd(int argc, char *argv[]);
 int wcCmd(int argc, char *argv[]);
 int filterCmd(int argc, char *argv[]);
@@ -61,6 +73,12 @@ void test_processes_wrapper(void *arg);
 void test_prio_wrapper(void *arg);
 void test_sync_wrapper(void *arg);
 void test_no_synchro_wrapper(void *arg);
+void test_ctxsw_wrapper(void *arg);
+void test_stacks_wrapper(void *arg);
+void test_pipe_wrapper(void *arg);
+void test_splice_wrapper(void *arg);
+void test_poll_wrapper(void *arg);
+void test_nonblock_wrapper(void *arg);
 void loop_process_entry(void *arg);
 void ps_process_entry(void *arg);
 void cat_process_entry(void *arg);
@@ -70,5 +88,6 @@ void mvar_writer_entry(void *arg);
 void mvar_reader_entry(void *arg);
 void mem_process_entry(void *arg);
 void mmtype_process_entry(void *arg);
+void slabinfo_process_entry(void *arg);
 
 #endif
@@ -23,6 +23,10 @@ typedef struct {
 	uint64_t allocations;
 	uint64_t frees;
 	uint64_t failed_allocations;
+	uint64_t internal_fragmentation;
+	uint64_t zeroed_bytes;
+	uint64_t split_ops;
+	uint64_t merge_ops;
 } memory_info_t;
 
 // Estados de proceso
@@ -35,6 +39,84 @@ typedef struct {
 #define PROCESS_NAME_MAX_LEN 32
 #define MAX_PROCESS_INFO 64
 
+#define SLAB_NAME_MAX_LEN 23
+#define MAX_SLAB_INFO 16
+
+typedef struct {
+	char name[SLAB_NAME_MAX_LEN + 1];
+	uint64_t object_size;
+	uint64_t objects_per_slab;
+	uint64_t slab_bytes;
+	uint64_t slabs_full;
+	uint64_t slabs_partial;
+	uint64_t slabs_empty;
+	uint64_t active_objects;
+	uint64_t total_objects;
+	uint64_t allocations;
+	uint64_t frees;
+} slab_info_t;
+
+// Profiler de allocaciones del kernel (comando memprof)
+#define MEMPROF_RING_SIZE 512
+#define MEMPROF_MAX_SITES 128
+
+typedef struct {
+	uint64_t caller;
+	uint64_t pid;
+	uint64_t live_bytes;
+	uint64_t live_blocks;
+	uint64_t peak_bytes;
+	uint64_t allocations;
+	uint64_t frees;
+} memprof_site_t;
+
+typedef struct {
+	uint64_t caller;
+	uint64_t ptr;
+	uint64_t size;
+	uint64_t pid;
+	uint64_t ticks;
+	uint64_t is_free;
+} memprof_event_t;
+
+typedef struct {
+	uint64_t enabled;
+	uint64_t events;
+	uint64_t sites;
+	uint64_t untracked;
+} memprof_status_t;
+
+// Heaps del kernel (uno por memory manager enlazado) y los usos que se les pueden asignar
+#define MAX_HEAP_INFO 3
+#define HEAP_NAME_MAX_LEN 16
+#define HEAP_USE_GENERAL 0
+#define HEAP_USE_STACKS 1
+#define HEAP_USE_PAGES 2
+#define HEAP_USE_USER 3
+#define HEAP_USE_COUNT 4
+
+typedef struct {
+	char name[HEAP_NAME_MAX_LEN];
+	uint64_t uses; // bit (1 << HEAP_USE_*) por cada uso asignado al heap
+	memory_info_t stats;
+} heap_info_t;
+
+// Estado de la paginacion del kernel, en el mismo orden que paging_stats_t
+typedef struct {
+	uint64_t enabled;
+	uint64_t pcid_supported;
+	uint64_t pcid_enabled;
+	uint64_t identity_bytes;
+	uint64_t address_spaces;
+	uint64_t user_pages;
+	uint64_t table_pages;
+	uint64_t switches;
+	uint64_t flushes;
+	uint64_t stacks;
+	uint64_t stack_pages;
+	uint64_t stack_faults;
+} paging_info_t;
+
 typedef struct {
 	uint64_t pid;
 	char name[PROCESS_NAME_MAX_LEN + 1];
@@ -43,6 +125,8 @@ typedef struct {
 	uint64_t rsp;
 	uint64_t rbp;
 	int foreground;
+	uint64_t mem_bytes;
+	uint64_t stack_bytes;
 } process_info_t;
 
 int putchar(int c);
@@ -57,14 +141,35 @@ int atoi(const char *str);
 char *fgets(char *s, int n, FILE *stream);
 void clearScreen();
 void *malloc(size_t size);
+// Solo el proceso que pidio el bloque puede liberarlo: en otro la direccion no esta mapeada y el page fault lo termina
 void free(void *ptr);
+void *calloc(size_t count, size_t size);
+void *realloc(void *ptr, size_t size);
+// alignment debe ser potencia de 2 (hasta 2 MB); el bloque se libera con free
+void *aligned_alloc(size_t alignment, size_t size);
 int memory_info(memory_info_t *info);
+// Memoria compartida con nombre: el segmento vive mientras haya algun proceso adjunto
+void *shm_create(const char *name, uint64_t size);
+void *shm_attach(const char *name, uint64_t *size);
+int shm_detach(void *address);
+uint64_t slab_info(slab_info_t *buffer, uint64_t max_count);
+int memprof_enable(int enabled);
+int memprof_status(memprof_status_t *status);
+uint64_t memprof_sites(memprof_site_t *buffer, uint64_t max_count);
+uint64_t memprof_events(memprof_event_t *buffer, uint64_t max_count);
+uint64_t heap_info(heap_info_t *buffer, uint64_t max_count);
+int set_heap_use(int use, int heap);
+int paging_status(paging_info_t *info);
+int paging_set_pcid(int enabled);
 int sprintf(char *str, const char *fmt, ...);
 void printHex64(uint64_t value);
 void sleep(int milliseconds);
 void shutdown();
 int getScreenDims(uint64_t *width, uint64_t *height);
 int64_t my_create_process(char *name, void *function, char *argv[], uint64_t priority, int is_foreground);
+// Los ids de pipe entran en 31 bits: my_create_process_with_pipes le pasa dos al kernel en un solo argumento
+#define PIPE_ID_BITS 31
+#define PIPE_ID_MASK ((1ULL << PIPE_ID_BITS) - 1)
 int64_t my_create_process_with_pipes(char *name, void *function, char *argv[], uint64_t priority, int is_foreground,
 									 uint64_t stdin_pipe_id, uint64_t stdout_pipe_id);
 int64_t my_kill(uint64_t pid);
@@ -72,6 +177,7 @@ int64_t my_block(uint64_t pid);
 int64_t my_unblock(uint64_t pid);
 int64_t my_getpid();
 int64_t my_nice(uint64_t pid, uint64_t newPrio);
+int64_t set_mem_quota(uint64_t pid, uint64_t bytes);
 int64_t my_wait(int64_t pid);
 int64_t my_sem_open(char *sem_id, uint64_t initialValue);
 int64_t my_sem_wait(char *sem_id);
@@ -84,10 +190,47 @@ void reset_last_spawned_pid(void);
 int64_t get_last_spawned_pid(void);
 
 uint64_t pipe_create(void);
+// Toma una referencia de escritor sin fd (mantiene vivo el pipe y demora su EOF); la suelta pipe_close
 uint64_t pipe_open(uint64_t pipe_id);
 uint64_t pipe_close(uint64_t pipe_id);
 uint64_t pipe_dup(uint64_t pipe_id, uint64_t fd, uint64_t mode);
 uint64_t pipe_release_fd(uint64_t fd);
+// Cambia la capacidad del buffer del pipe (se redondea a paginas, hasta 1 MB); size 0 consulta. 0 si falla
+uint64_t pipe_set_size(uint64_t pipe_id, uint64_t size);
+// Mueve hasta count bytes del pipe de lectura fd_in al de escritura fd_out dentro del kernel; 0 en EOF
+uint64_t pipe_splice(int fd_in, int fd_out, uint64_t count);
+/*
+ * Escritura por regalo: el buffer sale de pipe_gift_alloc y pipe_gift se lo entrega al pipe sin copiarlo.
+ * Si pipe_gift devuelve length el buffer ya no es del proceso; si devuelve 0 se libera con pipe_gift_free.
+ */
+void *pipe_gift_alloc(uint64_t size);
+uint64_t pipe_gift(int fd, void *buffer, uint64_t length);
+void pipe_gift_free(void *buffer);
+
+// Eventos de poll
+#define POLL_IN 0x01   // hay datos para leer
+#define POLL_OUT 0x04  // hay lugar para escribir
+#define POLL_HUP 0x10  // la otra punta del pipe se cerro (se informa aunque no se pida)
+#define POLL_NVAL 0x20 // el fd no es un pipe ni la terminal
+
+typedef struct {
+	int32_t fd; // los negativos se ignoran
+	int16_t events;
+	int16_t revents;
+} poll_fd_t;
+
+// Espera a que algun fd tenga eventos (hasta 16 fds). timeout_ms 0 no bloquea, negativo espera sin limite.
+// Devuelve cuantos fds tienen eventos, 0 si vencio el tiempo o -1 si falla
+int64_t poll(poll_fd_t *fds, uint64_t count, int64_t timeout_ms);
+
+// Flags por fd: con O_NONBLOCK, sys_read/sys_write devuelven WOULD_BLOCK en lugar de esperar
+#define O_NONBLOCK 0x800
+#define F_GETFL 3
+#define F_SETFL 4
+#define WOULD_BLOCK ((uint64_t) -1)
+
+// F_GETFL devuelve los flags del fd; F_SETFL los reemplaza por flags y devuelve 0. -1 si falla
+int64_t fcntl(int fd, int cmd, uint64_t flags);
 
 uint64_t get_foreground_pid(void);
 
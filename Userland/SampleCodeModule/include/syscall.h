@@ -33,9 +33,27 @@ uint64_t sys_sem_get(uint64_t sem_id);
 uint64_t sys_list_processes(void *buffer, uint64_t max_count);
 uint64_t sys_yield();
 uint64_t sys_pipe_create(void);
-uint64_t sys_pipe_open(uint64_t pipe_id);
+uint64_t sys_pipe_open(uint64_t pipe_id, uint64_t is_writer);
 uint64_t sys_pipe_close(uint64_t pipe_id);
 uint64_t sys_pipe_dup(uint64_t pipe_id, uint64_t fd, uint64_t mode);
 uint64_t sys_pipe_release_fd(uint64_t fd);
 uint64_t sys_get_foreground_pid();
+uint64_t sys_slab_info(void *buffer, uint64_t max_count);
+void *sys_region_alloc(uint64_t size);
+uint64_t sys_region_free(void *region);
+void **sys_user_heap_slot();
+uint64_t sys_set_mem_quota(uint64_t pid, uint64_t bytes);
+void *sys_region_alloc_aligned(uint64_t size, uint64_t align);
+uint64_t sys_mem_profile(uint64_t cmd, void *buffer, uint64_t max_count);
+void *sys_shm_create(const char *name, uint64_t size);
+void *sys_shm_attach(const char *name, uint64_t *size);
+uint64_t sys_shm_detach(void *address);
+uint64_t sys_heap_info(void *buffer, uint64_t max_count);
+uint64_t sys_set_heap_use(uint64_t use, uint64_t heap);
+uint64_t sys_paging_ctl(uint64_t cmd, void *buffer);
+uint64_t sys_pipe_set_size(uint64_t pipe_id, uint64_t size);
+uint64_t sys_pipe_splice(uint64_t fd_in, uint64_t fd_out, uint64_t count);
+uint64_t sys_pipe_gift(uint64_t fd, void *buffer, uint64_t length);
+int64_t sys_poll(void *fds, uint64_t count, int64_t timeout_ms);
+int64_t sys_fcntl(uint64_t fd, uint64_t cmd, uint64_t flags);
 #endif
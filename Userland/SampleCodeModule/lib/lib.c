@@ -36,7 +36,7 @@ uint64_t pipe_open(uint64_t pipe_id) {
 	if (pipe_id == 0) {
 		return 0;
 	}
-	return sys_pipe_open(pipe_id);
+	return sys_pipe_open(pipe_id, 1);
 }
 
 uint64_t pipe_close(uint64_t pipe_id) {
@@ -60,6 +60,55 @@ uint64_t pipe_release_fd(uint64_t fd) {
 	return sys_pipe_release_fd(fd);
 }
 
+uint64_t pipe_set_size(uint64_t pipe_id, uint64_t size) {
+	if (pipe_id == 0) {
+		return 0;
+	}
+	return sys_pipe_set_size(pipe_id, size);
+}
+
+uint64_t pipe_splice(int fd_in, int fd_out, uint64_t count) {
+	if (fd_in < 0 || fd_out < 0 || count == 0) {
+		return 0;
+	}
+	return sys_pipe_splice(fd_in, fd_out, count);
+}
+
+// Una region propia del kernel (no del heap de malloc), que es lo que pipe_gift puede entregar entera
+void *pipe_gift_alloc(uint64_t size) {
+	if (size == 0) {
+		return NULL;
+	}
+	return sys_region_alloc(size);
+}
+
+uint64_t pipe_gift(int fd, void *buffer, uint64_t length) {
+	if (fd < 0 || buffer == NULL || length == 0) {
+		return 0;
+	}
+	return sys_pipe_gift(fd, buffer, length);
+}
+
+void pipe_gift_free(void *buffer) {
+	if (buffer != NULL) {
+		sys_region_free(buffer);
+	}
+}
+
+int64_t poll(poll_fd_t *fds, uint64_t count, int64_t timeout_ms) {
+	if (fds == NULL && count > 0) {
+		return -1;
+	}
+	return sys_poll(fds, count, timeout_ms);
+}
+
+int64_t fcntl(int fd, int cmd, uint64_t flags) {
+	if (fd < 0) {
+		return -1;
+	}
+	return sys_fcntl(fd, cmd, flags);
+}
+
 uint64_t get_foreground_pid(void) {
 	return sys_get_foreground_pid();
 }
@@ -9,8 +9,6 @@ static int64_t g_last_spawned_pid = -1;
 
 extern int strcmp(const char *s1, const char *s2);
 extern size_t strlen(const char *s);
-extern void *malloc(size_t size);
-extern void free(void *ptr);
 
 static void *resolve_function_by_name(const char *name) {
 	if (name == NULL)
@@ -55,12 +53,13 @@ int64_t my_create_process_with_pipes(char *name, void *function, char *argv[], u
 		}
 	}
 
-	uint64_t packed =
-		(stdin_pipe_id & 0xFFFF) | ((stdout_pipe_id & 0xFFFF) << 16) | (((uint64_t) is_foreground & 0x1) << 32);
+	// Los ids de pipe del kernel entran en PIPE_ID_BITS bits (indice de slot y generacion)
+	uint64_t packed = (stdin_pipe_id & PIPE_ID_MASK) | ((stdout_pipe_id & PIPE_ID_MASK) << PIPE_ID_BITS) |
+					  (((uint64_t) is_foreground & 0x1) << (2 * PIPE_ID_BITS));
 
 	if (stdin_pipe_id != 0 || stdout_pipe_id != 0) {
 		// Marcar explícitamente que estamos usando el formato extendido (pipes)
-		packed |= (1ULL << 33);
+		packed |= (1ULL << 63);
 	}
 
 	int64_t pid = (int64_t) sys_create_process(name, function, argv, priority, packed);
@@ -90,6 +89,10 @@ int64_t my_nice(uint64_t pid, uint64_t newPrio) {
 	return (int64_t) sys_set_priority(pid, newPrio);
 }
 
+int64_t set_mem_quota(uint64_t pid, uint64_t bytes) {
+	return (int64_t) sys_set_mem_quota(pid, bytes);
+}
+
 int64_t my_yield() {
 	return (int64_t) sys_yield();
 }
@@ -115,14 +118,16 @@ int64_t get_last_spawned_pid(void) {
 
 
 #define MAX_USER_SEMS 8
-static char *user_sem_names[MAX_USER_SEMS];
+#define MAX_USER_SEM_NAME 32
+// Los nombres se guardan en la tabla (compartida por todos los procesos), no en el heap privado de quien abrio
+static char user_sem_names[MAX_USER_SEMS][MAX_USER_SEM_NAME];
 static uint64_t user_sem_ids[MAX_USER_SEMS];
 
 static int find_sem_index(const char *name) {
 	if (!name)
 		return -1;
 	for (int i = 0; i < MAX_USER_SEMS; ++i) {
-		if (user_sem_names[i] && strcmp(user_sem_names[i], name) == 0)
+		if (user_sem_names[i][0] && strcmp(user_sem_names[i], name) == 0)
 			return i;
 	}
 	return -1;
@@ -130,7 +135,7 @@ static int find_sem_index(const char *name) {
 
 static int find_free_sem_slot(void) {
 	for (int i = 0; i < MAX_USER_SEMS; ++i)
-		if (!user_sem_names[i])
+		if (!user_sem_names[i][0])
 			return i;
 	return -1;
 }
@@ -143,21 +148,17 @@ int64_t my_sem_open(char *sem_id, uint64_t initialValue) {
 		sys_sem_open(user_sem_ids[idx]);
 		return 1;
 	}
+	size_t len = strlen(sem_id) + 1;
+	if (len > MAX_USER_SEM_NAME)
+		return 0;
 	int free = find_free_sem_slot();
 	if (free < 0)
 		return 0;
 	uint64_t id = sys_sem_create((int) initialValue);
 	if (!id)
 		return 0;
-	size_t len = strlen(sem_id) + 1;
-	char *copy = (char *) malloc(len);
-	if (!copy) {
-		sys_sem_close(id);
-		return 0;
-	}
 	for (size_t i = 0; i < len; ++i)
-		copy[i] = sem_id[i];
-	user_sem_names[free] = copy;
+		user_sem_names[free][i] = sem_id[i];
 	user_sem_ids[free] = id;
 	return 1;
 }
@@ -188,8 +189,7 @@ int64_t my_sem_close(char *sem_id) {
 		return 0;
 	uint64_t id = user_sem_ids[idx];
 	int64_t res = (int64_t) sys_sem_close(id);
-	free(user_sem_names[idx]);
-	user_sem_names[idx] = NULL;
+	user_sem_names[idx][0] = '\0';
 	user_sem_ids[idx] = 0;
 	return res;
 }
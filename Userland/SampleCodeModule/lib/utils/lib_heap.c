@@ -0,0 +1,492 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "../../include/lib.h"
+#include "../../include/syscall.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Heap de userland por proceso. Cada proceso pide regiones grandes al kernel (sys_region_alloc) y las
+ * reparte con bins por potencia de 2 y boundary tags, asi la mayoria de malloc/free no hacen syscalls.
+ * El heap propio se ancla en la primera palabra de la pagina local del proceso, que el kernel mapea en la misma
+ * direccion en todos los espacios con un marco distinto: heap_slot se puede guardar en una global compartida.
+ * Las regiones solo estan mapeadas en la ventana del proceso que las pidio, asi que un bloque no se puede
+ * liberar (ni usar) desde otro proceso: leer su header da page fault y el kernel termina al que libera.
+ */
+
+#define HEAP_ALIGNMENT 16ULL
+#define HEAP_PAGE_SIZE 0x1000ULL
+#define HEAP_REGION_SIZE (64ULL * 1024ULL)
+#define HEAP_LARGE_THRESHOLD (HEAP_REGION_SIZE / 2) // pedidos mayores van a una region propia
+#define HEAP_MAX_ALIGN 0x200000ULL
+#define HEAP_BIN_COUNT 64
+#define HEAP_MAGIC 0x50414548554c4942ULL
+
+#define CHUNK_USED 1ULL
+#define CHUNK_PREV_FREE 2ULL
+#define CHUNK_LARGE 4ULL
+#define CHUNK_REGION_START 8ULL // primer chunk de una region secundaria: si queda libre entero se devuelve
+#define CHUNK_FLAGS 15ULL
+
+typedef struct heap heap_t;
+typedef struct chunk chunk_t;
+typedef struct region region_t;
+
+// Los enlaces solo son validos en chunks libres; los libres guardan ademas su tamaño en los ultimos 8 bytes
+struct chunk {
+	uint64_t size_and_flags;
+	heap_t *heap;
+	chunk_t *next_free;
+	chunk_t *prev_free;
+};
+
+// base es el bloque pedido al kernel: coincide con la region salvo en los pedidos grandes alineados
+struct region {
+	region_t *next;
+	region_t *prev;
+	uint64_t size;
+	void *base;
+};
+
+struct heap {
+	uint64_t magic;
+	region_t *regions;
+	chunk_t *bins[HEAP_BIN_COUNT];
+	uint64_t nonempty_bins;
+};
+
+#define CHUNK_HEADER_SIZE 16ULL
+#define CHUNK_MIN_SIZE 48ULL
+#define REGION_HEADER_SIZE sizeof(region_t)
+
+static void **heap_slot = NULL;
+
+static inline uint64_t align_up(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline uint64_t chunk_size(const chunk_t *c) {
+	return c->size_and_flags & ~CHUNK_FLAGS;
+}
+
+static inline chunk_t *chunk_next(const chunk_t *c) {
+	return (chunk_t *) ((uint8_t *) c + chunk_size(c));
+}
+
+static inline chunk_t *chunk_prev(const chunk_t *c) {
+	uint64_t prev_size = *((const uint64_t *) c - 1);
+	return (chunk_t *) ((uint8_t *) c - prev_size);
+}
+
+static inline void *chunk_payload(chunk_t *c) {
+	return (uint8_t *) c + CHUNK_HEADER_SIZE;
+}
+
+static inline chunk_t *payload_chunk(void *ptr) {
+	return (chunk_t *) ((uint8_t *) ptr - CHUNK_HEADER_SIZE);
+}
+
+static inline int bin_for(uint64_t size) {
+	return 63 - __builtin_clzll(size);
+}
+
+static void bin_insert(heap_t *h, chunk_t *c) {
+	int bin = bin_for(chunk_size(c));
+	c->prev_free = NULL;
+	c->next_free = h->bins[bin];
+	if (c->next_free != NULL) {
+		c->next_free->prev_free = c;
+	}
+	h->bins[bin] = c;
+	h->nonempty_bins |= (1ULL << bin);
+}
+
+static void bin_remove(heap_t *h, chunk_t *c) {
+	int bin = bin_for(chunk_size(c));
+	if (c->prev_free != NULL) {
+		c->prev_free->next_free = c->next_free;
+	}
+	else {
+		h->bins[bin] = c->next_free;
+	}
+	if (c->next_free != NULL) {
+		c->next_free->prev_free = c->prev_free;
+	}
+	if (h->bins[bin] == NULL) {
+		h->nonempty_bins &= ~(1ULL << bin);
+	}
+}
+
+// Marca el chunk como libre con su footer y avisa al siguiente; conserva CHUNK_PREV_FREE y CHUNK_REGION_START
+static void chunk_set_free(chunk_t *c, uint64_t size) {
+	c->size_and_flags = size | (c->size_and_flags & (CHUNK_PREV_FREE | CHUNK_REGION_START));
+	*(uint64_t *) ((uint8_t *) c + size - sizeof(uint64_t)) = size;
+	chunk_next(c)->size_and_flags |= CHUNK_PREV_FREE;
+}
+
+static void chunk_set_used(chunk_t *c) {
+	c->size_and_flags |= CHUNK_USED;
+	chunk_next(c)->size_and_flags &= ~CHUNK_PREV_FREE;
+}
+
+static chunk_t *find_fit(heap_t *h, uint64_t required) {
+	int bin = bin_for(required);
+	if (h->nonempty_bins & (1ULL << bin)) {
+		chunk_t *best = NULL;
+		for (chunk_t *c = h->bins[bin]; c != NULL; c = c->next_free) {
+			uint64_t size = chunk_size(c);
+			if (size >= required && (best == NULL || size < chunk_size(best))) {
+				best = c;
+				if (size == required) {
+					break;
+				}
+			}
+		}
+		if (best != NULL) {
+			return best;
+		}
+	}
+
+	uint64_t larger = (bin + 1 < HEAP_BIN_COUNT) ? (h->nonempty_bins & (~0ULL << (bin + 1))) : 0;
+	if (larger == 0) {
+		return NULL;
+	}
+	return h->bins[__builtin_ctzll(larger)];
+}
+
+static void region_link(heap_t *h, region_t *r) {
+	r->prev = NULL;
+	r->next = h->regions;
+	if (r->next != NULL) {
+		r->next->prev = r;
+	}
+	h->regions = r;
+}
+
+static void region_unlink(heap_t *h, region_t *r) {
+	if (r->prev != NULL) {
+		r->prev->next = r->next;
+	}
+	else {
+		h->regions = r->next;
+	}
+	if (r->next != NULL) {
+		r->next->prev = r->prev;
+	}
+}
+
+// Arma un chunk libre en [start, end) de la region con un centinela usado al final
+static void region_format(heap_t *h, uint8_t *start, uint8_t *end, uint64_t flags) {
+	chunk_t *sentinel = (chunk_t *) (end - CHUNK_HEADER_SIZE);
+	sentinel->size_and_flags = CHUNK_USED;
+	sentinel->heap = h;
+
+	chunk_t *c = (chunk_t *) start;
+	c->size_and_flags = flags;
+	c->heap = h;
+	chunk_set_free(c, (uint64_t) ((uint8_t *) sentinel - start));
+	bin_insert(h, c);
+}
+
+static heap_t *heap_create(void) {
+	region_t *r = (region_t *) sys_region_alloc(HEAP_REGION_SIZE);
+	if (r == NULL) {
+		return NULL;
+	}
+	r->size = HEAP_REGION_SIZE;
+	r->base = r;
+
+	heap_t *h = (heap_t *) ((uint8_t *) r + REGION_HEADER_SIZE);
+	h->magic = HEAP_MAGIC;
+	h->regions = NULL;
+	for (int i = 0; i < HEAP_BIN_COUNT; i++) {
+		h->bins[i] = NULL;
+	}
+	h->nonempty_bins = 0;
+	region_link(h, r);
+
+	uint8_t *start = (uint8_t *) align_up((uint64_t) h + sizeof(heap_t), HEAP_ALIGNMENT);
+	region_format(h, start, (uint8_t *) r + HEAP_REGION_SIZE, 0);
+	return h;
+}
+
+static int heap_grow(heap_t *h, uint64_t required) {
+	uint64_t size = align_up(REGION_HEADER_SIZE + required + CHUNK_HEADER_SIZE, HEAP_PAGE_SIZE);
+	if (size < HEAP_REGION_SIZE) {
+		size = HEAP_REGION_SIZE;
+	}
+
+	region_t *r = (region_t *) sys_region_alloc(size);
+	if (r == NULL) {
+		return 0;
+	}
+	r->size = size;
+	r->base = r;
+	region_link(h, r);
+	region_format(h, (uint8_t *) r + REGION_HEADER_SIZE, (uint8_t *) r + size, CHUNK_REGION_START);
+	return 1;
+}
+
+static heap_t *current_heap(int create) {
+	if (heap_slot == NULL) {
+		heap_slot = sys_user_heap_slot();
+		if (heap_slot == NULL) {
+			return NULL;
+		}
+	}
+	heap_t *h = (heap_t *) *heap_slot;
+	if (h == NULL && create) {
+		h = heap_create();
+		*heap_slot = h;
+	}
+	return h;
+}
+
+static void free_chunk(heap_t *h, chunk_t *c) {
+	if (c->size_and_flags & CHUNK_LARGE) {
+		region_t *r = (region_t *) ((uint8_t *) c - REGION_HEADER_SIZE);
+		region_unlink(h, r);
+		sys_region_free(r->base);
+		return;
+	}
+
+	uint64_t size = chunk_size(c);
+	if (c->size_and_flags & CHUNK_PREV_FREE) {
+		chunk_t *prev = chunk_prev(c);
+		bin_remove(h, prev);
+		size += chunk_size(prev);
+		c = prev;
+	}
+	chunk_t *next = (chunk_t *) ((uint8_t *) c + size);
+	if (!(next->size_and_flags & CHUNK_USED)) {
+		bin_remove(h, next);
+		size += chunk_size(next);
+	}
+
+	c->size_and_flags &= ~CHUNK_USED;
+	chunk_set_free(c, size);
+
+	// Una region secundaria que quedo entera libre vuelve al kernel
+	if ((c->size_and_flags & CHUNK_REGION_START) && chunk_size(chunk_next(c)) == 0) {
+		region_t *r = (region_t *) ((uint8_t *) c - REGION_HEADER_SIZE);
+		region_unlink(h, r);
+		sys_region_free(r->base);
+		return;
+	}
+	bin_insert(h, c);
+}
+
+// Recorta el chunk usado a required bytes y libera el sobrante (que se une con el siguiente si esta libre)
+static void split_used(heap_t *h, chunk_t *c, uint64_t required) {
+	uint64_t size = chunk_size(c);
+	if (size < required + CHUNK_MIN_SIZE) {
+		return;
+	}
+	chunk_t *rest = (chunk_t *) ((uint8_t *) c + required);
+	rest->size_and_flags = (size - required) | CHUNK_USED;
+	rest->heap = h;
+	c->size_and_flags = required | (c->size_and_flags & CHUNK_FLAGS);
+	free_chunk(h, rest);
+}
+
+static uint64_t required_size(size_t size) {
+	uint64_t required = align_up((uint64_t) size + CHUNK_HEADER_SIZE, HEAP_ALIGNMENT);
+	return (required < CHUNK_MIN_SIZE) ? CHUNK_MIN_SIZE : required;
+}
+
+static void *large_alloc(heap_t *h, uint64_t required) {
+	uint64_t size = align_up(REGION_HEADER_SIZE + required, HEAP_PAGE_SIZE);
+	region_t *r = (region_t *) sys_region_alloc(size);
+	if (r == NULL) {
+		return NULL;
+	}
+	r->size = size;
+	r->base = r;
+	region_link(h, r);
+
+	chunk_t *c = (chunk_t *) ((uint8_t *) r + REGION_HEADER_SIZE);
+	c->size_and_flags = (size - REGION_HEADER_SIZE) | CHUNK_USED | CHUNK_LARGE;
+	c->heap = h;
+	return chunk_payload(c);
+}
+
+void *malloc(size_t size) {
+	if (size == 0 || size > (size_t) (-1) / 2) {
+		return NULL;
+	}
+	heap_t *h = current_heap(1);
+	if (h == NULL) {
+		return NULL;
+	}
+
+	uint64_t required = required_size(size);
+	if (required > HEAP_LARGE_THRESHOLD) {
+		return large_alloc(h, required);
+	}
+
+	chunk_t *c = find_fit(h, required);
+	if (c == NULL) {
+		if (!heap_grow(h, required)) {
+			return NULL;
+		}
+		c = find_fit(h, required);
+	}
+	bin_remove(h, c);
+	chunk_set_used(c);
+	split_used(h, c, required);
+	return chunk_payload(c);
+}
+
+/*
+ * Los pedidos chicos salen de un chunk del heap con lugar para el peor relleno: el relleno inicial queda como
+ * chunk libre. Los grandes usan una region alineada del kernel con los headers en el relleno de align bytes.
+ */
+void *aligned_alloc(size_t alignment, size_t size) {
+	if (alignment <= HEAP_ALIGNMENT) {
+		return malloc(size);
+	}
+	if (size == 0 || size > (size_t) (-1) / 4 || (alignment & (alignment - 1)) || alignment > HEAP_MAX_ALIGN) {
+		return NULL;
+	}
+	heap_t *h = current_heap(1);
+	if (h == NULL) {
+		return NULL;
+	}
+
+	uint64_t required = required_size(size);
+	uint64_t worst = required + alignment + CHUNK_MIN_SIZE;
+	if (worst > HEAP_LARGE_THRESHOLD) {
+		uint64_t offset = align_up(REGION_HEADER_SIZE + CHUNK_HEADER_SIZE, alignment);
+		uint64_t span = align_up(offset + required - CHUNK_HEADER_SIZE, HEAP_PAGE_SIZE);
+		uint8_t *base = (uint8_t *) sys_region_alloc_aligned(span, alignment);
+		if (base == NULL) {
+			return NULL;
+		}
+		uint8_t *payload = base + offset;
+		chunk_t *c = payload_chunk(payload);
+		region_t *r = (region_t *) ((uint8_t *) c - REGION_HEADER_SIZE);
+		r->size = span - (uint64_t) ((uint8_t *) r - base);
+		r->base = base;
+		region_link(h, r);
+		c->size_and_flags = (span - (uint64_t) ((uint8_t *) c - base)) | CHUNK_USED | CHUNK_LARGE;
+		c->heap = h;
+		return payload;
+	}
+
+	chunk_t *c = find_fit(h, worst);
+	if (c == NULL) {
+		if (!heap_grow(h, worst)) {
+			return NULL;
+		}
+		c = find_fit(h, worst);
+	}
+	bin_remove(h, c);
+
+	uint64_t payload = align_up((uint64_t) chunk_payload(c), alignment);
+	uint64_t padding = payload - (uint64_t) chunk_payload(c);
+	if (padding != 0 && padding < CHUNK_MIN_SIZE) {
+		padding += alignment;
+	}
+	if (padding != 0) {
+		chunk_t *aligned = (chunk_t *) ((uint8_t *) c + padding);
+		aligned->size_and_flags = chunk_size(c) - padding;
+		aligned->heap = h;
+		chunk_set_free(c, padding);
+		bin_insert(h, c);
+		c = aligned;
+	}
+	chunk_set_used(c);
+	split_used(h, c, required);
+	return chunk_payload(c);
+}
+
+/*
+ * Solo libera bloques del heap del proceso que llama. Antes un bloque de otro proceso se encolaba para que lo
+ * liberara su duenio; ahora su region no esta mapeada aca, asi que leer el header da page fault y el kernel
+ * termina al proceso. Un header que no es de este heap (puntero invalido o ya liberado) se ignora.
+ */
+void free(void *ptr) {
+	if (ptr == NULL) {
+		return;
+	}
+	chunk_t *c = payload_chunk(ptr);
+	heap_t *owner = c->heap;
+	if (owner == NULL || owner->magic != HEAP_MAGIC || !(c->size_and_flags & CHUNK_USED)) {
+		return;
+	}
+
+	heap_t *h = current_heap(0);
+	if (owner != h) {
+		return;
+	}
+	free_chunk(h, c);
+}
+
+void *calloc(size_t count, size_t size) {
+	if (size != 0 && count > (size_t) (-1) / size) {
+		return NULL;
+	}
+	void *ptr = malloc(count * size);
+	// Las regiones propias de los pedidos grandes ya vienen en cero del kernel
+	if (ptr != NULL && !(payload_chunk(ptr)->size_and_flags & CHUNK_LARGE)) {
+		memset(ptr, 0, count * size);
+	}
+	return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+	if (ptr == NULL) {
+		return malloc(size);
+	}
+	if (size == 0) {
+		free(ptr);
+		return NULL;
+	}
+
+	chunk_t *c = payload_chunk(ptr);
+	heap_t *owner = c->heap;
+	if (owner == NULL || owner->magic != HEAP_MAGIC || !(c->size_and_flags & CHUNK_USED) || size > (size_t) (-1) / 2) {
+		return NULL;
+	}
+
+	heap_t *h = current_heap(0);
+	uint64_t required = required_size(size);
+	uint64_t current = chunk_size(c);
+	if (c->size_and_flags & CHUNK_LARGE) {
+		if (required <= current) {
+			return ptr;
+		}
+	}
+	else if (owner == h) {
+		if (required <= current) {
+			split_used(h, c, required);
+			return ptr;
+		}
+
+		// Crecimiento en el lugar absorbiendo el chunk siguiente si esta libre y alcanza
+		chunk_t *next = chunk_next(c);
+		if (!(next->size_and_flags & CHUNK_USED) && current + chunk_size(next) >= required) {
+			bin_remove(h, next);
+			c->size_and_flags = (current + chunk_size(next)) | (c->size_and_flags & CHUNK_FLAGS);
+			chunk_set_used(c);
+			split_used(h, c, required);
+			return ptr;
+		}
+	}
+
+	void *moved = malloc(size);
+	if (moved == NULL) {
+		return NULL;
+	}
+	uint64_t to_copy = current - CHUNK_HEADER_SIZE;
+	if (to_copy > size) {
+		to_copy = size;
+	}
+	uint8_t *dst = (uint8_t *) moved;
+	const uint8_t *src = (const uint8_t *) ptr;
+	for (uint64_t i = 0; i < to_copy; i++) {
+		dst[i] = src[i];
+	}
+	free(ptr);
+	return moved;
+}
@@ -4,21 +4,101 @@
 #include "../../include/syscall.h"
 #include <stddef.h>
 
-void *malloc(size_t size) {
-	return (void *) sys_malloc(size);
+int memory_info(memory_info_t *info) {
+	if (info == NULL) {
+		return 0;
+	}
+	return (int) sys_meminfo(info);
 }
 
-void free(void *ptr) {
-	if (ptr != NULL) {
-		sys_free(ptr);
+uint64_t slab_info(slab_info_t *buffer, uint64_t max_count) {
+	if (buffer == NULL || max_count == 0) {
+		return 0;
 	}
+	return sys_slab_info(buffer, max_count);
 }
 
-int memory_info(memory_info_t *info) {
+void *shm_create(const char *name, uint64_t size) {
+	if (name == NULL || size == 0) {
+		return NULL;
+	}
+	return sys_shm_create(name, size);
+}
+
+void *shm_attach(const char *name, uint64_t *size) {
+	if (name == NULL) {
+		return NULL;
+	}
+	return sys_shm_attach(name, size);
+}
+
+int shm_detach(void *address) {
+	if (address == NULL) {
+		return 0;
+	}
+	return (int) sys_shm_detach(address);
+}
+
+// Comandos de sys_mem_profile, en el mismo orden que MM_PROF_CMD_* del kernel
+#define MEMPROF_CMD_STATUS 0
+#define MEMPROF_CMD_SITES 1
+#define MEMPROF_CMD_EVENTS 2
+#define MEMPROF_CMD_ENABLE 3
+#define MEMPROF_CMD_DISABLE 4
+
+int memprof_enable(int enabled) {
+	return (int) sys_mem_profile(enabled ? MEMPROF_CMD_ENABLE : MEMPROF_CMD_DISABLE, NULL, 0);
+}
+
+int memprof_status(memprof_status_t *status) {
+	if (status == NULL) {
+		return 0;
+	}
+	return (int) sys_mem_profile(MEMPROF_CMD_STATUS, status, 0);
+}
+
+uint64_t memprof_sites(memprof_site_t *buffer, uint64_t max_count) {
+	if (buffer == NULL || max_count == 0) {
+		return 0;
+	}
+	return sys_mem_profile(MEMPROF_CMD_SITES, buffer, max_count);
+}
+
+uint64_t memprof_events(memprof_event_t *buffer, uint64_t max_count) {
+	if (buffer == NULL || max_count == 0) {
+		return 0;
+	}
+	return sys_mem_profile(MEMPROF_CMD_EVENTS, buffer, max_count);
+}
+
+uint64_t heap_info(heap_info_t *buffer, uint64_t max_count) {
+	if (buffer == NULL || max_count == 0) {
+		return 0;
+	}
+	return sys_heap_info(buffer, max_count);
+}
+
+int set_heap_use(int use, int heap) {
+	if (use < 0 || use >= HEAP_USE_COUNT || heap < 0 || heap >= MAX_HEAP_INFO) {
+		return 0;
+	}
+	return (int) sys_set_heap_use((uint64_t) use, (uint64_t) heap);
+}
+
+// Comandos de sys_paging_ctl, en el mismo orden que PAGING_CMD_* del kernel
+#define PAGING_CMD_STATUS 0
+#define PAGING_CMD_PCID_ON 1
+#define PAGING_CMD_PCID_OFF 2
+
+int paging_status(paging_info_t *info) {
 	if (info == NULL) {
 		return 0;
 	}
-	return (int) sys_meminfo(info);
+	return (int) sys_paging_ctl(PAGING_CMD_STATUS, info);
+}
+
+int paging_set_pcid(int enabled) {
+	return (int) sys_paging_ctl(enabled ? PAGING_CMD_PCID_ON : PAGING_CMD_PCID_OFF, NULL);
 }
 
 int get_type_of_mm(char *buf, int buflen) {
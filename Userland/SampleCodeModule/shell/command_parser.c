@@ -7,7 +7,8 @@
 
 static int find_command_index(const char *name);
 static int contains_pipe_symbol(const char *input);
-static int execute_pipeline(char *left_input, char *right_input);
+static int split_pipeline(char *input, char *segments[]);
+static int execute_pipeline(char *segments[], int count);
 
 void *get_process_entry_function(int cmd_idx) {
 	if (cmd_idx < 0)
@@ -31,6 +32,8 @@ void *get_process_entry_function(int cmd_idx) {
 		return (void *) mem_process_entry;
 	if (strcmp(name, "mmtype") == 0)
 		return (void *) mmtype_process_entry;
+	if (strcmp(name, "slabinfo") == 0)
+		return (void *) slabinfo_process_entry;
 	if (strcmp(name, "testmm") == 0)
 		return (void *) test_mm_process_wrapper;
 	if (strcmp(name, "test_proceses") == 0)
@@ -96,146 +99,132 @@ static int contains_pipe_symbol(const char *input) {
 	return 0;
 }
 
-static int execute_pipeline(char *left_input, char *right_input) {
-	char *left_args[MAX_ARGS];
-	char *right_args[MAX_ARGS];
-
-	int left_argc = fillCommandAndArgs(left_args, left_input);
-	int right_argc = fillCommandAndArgs(right_args, right_input);
-
-	if (left_argc == 0 || right_argc == 0) {
-		printf("Error: formato de pipe invalido.\n");
-		return CMD_ERROR;
-	}
-
-	if ((left_argc > 0 && strcmp(left_args[left_argc - 1], "&") == 0) ||
-		(right_argc > 0 && strcmp(right_args[right_argc - 1], "&") == 0)) {
-		printf("Error: los pipes no soportan ejecucion en background.\n");
-		return CMD_ERROR;
-	}
-
-	int left_idx = find_command_index(left_args[0]);
-	int right_idx = find_command_index(right_args[0]);
-
-	if (left_idx < 0 || right_idx < 0) {
-		return ERROR;
+// Corta el input en cada '|'; -1 si hay mas de MAX_PIPELINE_STAGES etapas
+static int split_pipeline(char *input, char *segments[]) {
+	int count = 0;
+	segments[count++] = input;
+	for (char *it = input; *it; ++it) {
+		if (*it == '|') {
+			if (count == MAX_PIPELINE_STAGES) {
+				return -1;
+			}
+			*it = '\0';
+			segments[count++] = it + 1;
+		}
 	}
+	return count;
+}
 
-	if (shellCmds[left_idx].is_builtin || shellCmds[right_idx].is_builtin) {
-		printf("Error: los pipes solo pueden usarse con comandos externos.\n");
-		return CMD_ERROR;
-	}
+/*
+ * Lanza todas las etapas juntas, cada una con su stdin y stdout en los pipes de sus vecinas. El shell
+ * tiene una referencia de escritor en cada pipe mientras crea las etapas, asi ninguno se destruye ni da
+ * EOF antes de que existan las dos puntas. Despues la suelta: cuando una etapa termina se cierra su
+ * salida y la siguiente lee EOF al vaciar el pipe, en lugar de que el shell mate a la que escribe.
+ */
+static int execute_pipeline(char *segments[], int count) {
+	static char *stage_argv[MAX_PIPELINE_STAGES][MAX_ARGS + 1];
+	int stage_idx[MAX_PIPELINE_STAGES];
+	void *stage_function[MAX_PIPELINE_STAGES];
+	uint64_t pipes[MAX_PIPELINE_STAGES - 1];
+	int64_t pids[MAX_PIPELINE_STAGES];
+
+	for (int i = 0; i < count; i++) {
+		char *args[MAX_ARGS];
+		int argc = fillCommandAndArgs(args, segments[i]);
 
-	uint64_t pipe_id = pipe_create();
-	if (pipe_id == 0) {
-		printf("Error: no se pudo crear el pipe.\n");
-		return CMD_ERROR;
-	}
+		if (argc == 0) {
+			printf("Error: formato de pipe invalido.\n");
+			return CMD_ERROR;
+		}
+		if (strcmp(args[argc - 1], "&") == 0) {
+			printf("Error: los pipes no soportan ejecucion en background.\n");
+			return CMD_ERROR;
+		}
 
-	void *left_function = get_process_entry_function(left_idx);
-	void *right_function = get_process_entry_function(right_idx);
+		stage_idx[i] = find_command_index(args[0]);
+		if (stage_idx[i] < 0) {
+			return ERROR;
+		}
+		if (shellCmds[stage_idx[i]].is_builtin) {
+			printf("Error: los pipes solo pueden usarse con comandos externos.\n");
+			return CMD_ERROR;
+		}
+		stage_function[i] = get_process_entry_function(stage_idx[i]);
+		if (!stage_function[i]) {
+			printf("Error: el comando '%s' no puede usarse en un pipe.\n", shellCmds[stage_idx[i]].name);
+			return CMD_ERROR;
+		}
 
-	if (!left_function || !right_function) {
-		printf("Error: no se pudo obtener la funcion de entrada del proceso.\n");
-		return CMD_ERROR;
+		// El kernel copia argv al crear el proceso, asi que alcanza con apuntar al input
+		for (int j = 1; j < argc; j++) {
+			stage_argv[i][j - 1] = args[j];
+		}
+		stage_argv[i][argc - 1] = NULL;
 	}
 
-	char **left_process_argv = NULL;
-	if (left_argc > 1) {
-		left_process_argv = (char **) malloc((left_argc) * sizeof(char *));
-		if (left_process_argv) {
-			for (int i = 1; i < left_argc; i++) {
-				int len = strlen(left_args[i]) + 1;
-				left_process_argv[i - 1] = (char *) malloc(len);
-				if (left_process_argv[i - 1]) {
-					strncpy(left_process_argv[i - 1], left_args[i], len);
-				}
-			}
-			left_process_argv[left_argc - 1] = NULL;
+	int created = 0;
+	for (; created < count - 1; created++) {
+		pipes[created] = pipe_create();
+		if (pipes[created] == 0 || !pipe_open(pipes[created])) {
+			break;
 		}
 	}
-
-	char **right_process_argv = NULL;
-	if (right_argc > 1) {
-		right_process_argv = (char **) malloc((right_argc) * sizeof(char *));
-		if (right_process_argv) {
-			for (int i = 1; i < right_argc; i++) {
-				int len = strlen(right_args[i]) + 1;
-				right_process_argv[i - 1] = (char *) malloc(len);
-				if (right_process_argv[i - 1]) {
-					strncpy(right_process_argv[i - 1], right_args[i], len);
-				}
-			}
-			right_process_argv[right_argc - 1] = NULL;
+	if (created < count - 1) {
+		for (int i = 0; i < created; i++) {
+			pipe_close(pipes[i]);
 		}
+		printf("Error: no se pudo crear el pipe.\n");
+		return CMD_ERROR;
 	}
 
-	int64_t left_pid =
-		execute_external_command(shellCmds[left_idx].name, left_function, left_process_argv, 0, 0, pipe_id);
-
-	int status = CMD_ERROR;
-	int64_t right_pid = -1;
-
-	if (left_pid > 0) {
-		right_pid =
-			execute_external_command(shellCmds[right_idx].name, right_function, right_process_argv, 1, pipe_id, 0);
-
-		if (right_pid > 0) {
-			status = OK;
-		}
-		else {
-			printf("Error: el comando '%s' no puede usarse en un pipe.\n", shellCmds[right_idx].name);
-			my_kill(left_pid);
+	/*
+	 * Solo la primera etapa va en foreground: es la que puede leer el teclado y la que corta Ctrl-C, y al
+	 * terminar cierra su salida y las demas ven EOF en cadena.
+	 */
+	int spawned = 0;
+	for (; spawned < count; spawned++) {
+		uint64_t stdin_pipe = spawned > 0 ? pipes[spawned - 1] : 0;
+		uint64_t stdout_pipe = spawned < count - 1 ? pipes[spawned] : 0;
+		char **argv = stage_argv[spawned][0] ? stage_argv[spawned] : NULL;
+		pids[spawned] = my_create_process_with_pipes((char *) shellCmds[stage_idx[spawned]].name,
+													 stage_function[spawned], argv, 1, spawned == 0, stdin_pipe,
+													 stdout_pipe);
+		if (pids[spawned] <= 0) {
+			break;
 		}
 	}
-	else {
-		printf("Error: el comando '%s' no puede usarse en un pipe.\n", shellCmds[left_idx].name);
-	}
-
-
-	if (status == OK && left_pid > 0) {
-		
-		my_yield();
 
-		my_kill(left_pid);
+	for (int i = 0; i < count - 1; i++) {
+		pipe_close(pipes[i]);
 	}
 
-	if (left_process_argv) {
-		for (int i = 0; left_process_argv[i] != NULL; i++) {
-			free(left_process_argv[i]);
+	if (spawned < count) {
+		printf("Error: no se pudo crear el proceso '%s'.\n", shellCmds[stage_idx[spawned]].name);
+		for (int i = 0; i < spawned; i++) {
+			my_kill(pids[i]);
 		}
-		free(left_process_argv);
-	}
-	if (right_process_argv) {
-		for (int i = 0; right_process_argv[i] != NULL; i++) {
-			free(right_process_argv[i]);
-		}
-		free(right_process_argv);
+		return CMD_ERROR;
 	}
 
-	return status;
+	// La primera se espera al final: el kernel devuelve el foreground a la shell recien cuando la recoge
+	for (int i = count - 1; i >= 0; i--) {
+		my_wait(pids[i]);
+	}
+	return OK;
 }
 
 int CommandParse(char *commandInput) {
 	if (commandInput == NULL)
 		return ERROR;
 
-	for (char *p = commandInput; *p; ++p) {
-		if (*p == '|') {
-			char *right_input = p + 1;
-			*p = '\0';
-
-			while (*right_input == ' ') {
-				right_input++;
-			}
-
-			if (contains_pipe_symbol(right_input)) {
-				printf("Error: solo se admite un pipe por comando.\n");
-				return CMD_ERROR;
-			}
-
-			return execute_pipeline(commandInput, right_input);
+	if (contains_pipe_symbol(commandInput)) {
+		char *segments[MAX_PIPELINE_STAGES];
+		int count = split_pipeline(commandInput, segments);
+		if (count < 0) {
+			printf("Error: se admiten hasta %d comandos por pipeline.\n", MAX_PIPELINE_STAGES);
+			return CMD_ERROR;
 		}
+		return execute_pipeline(segments, count);
 	}
 
 	char *args[MAX_ARGS];
@@ -16,6 +16,12 @@ const TShellCmd shellCmds[] = {
 	{"test_no_synchro", testNoSynchroCmd, ": Ejecuta test sin sincronizacion. Uso: test_no_synchro <repeticiones>\n",
 	 0},
 	{"test_priority", testPriorityCmd, ": Ejecuta el test de prioridades. Uso: test_priority <max_value>\n", 0},
+	{"test_ctxsw", testCtxswCmd, ": Mide el costo de los context switch. Uso: test_ctxsw <iteraciones>\n", 0},
+	{"test_stacks", testStacksCmd, ": Verifica que se liberen los stacks de kernel. Uso: test_stacks <procesos>\n", 0},
+	{"test_pipe", testPipeCmd, ": Mide el ancho de banda de un pipe. Uso: test_pipe <KB> [capacidad]\n", 0},
+	{"test_splice", testSpliceCmd, ": Prueba pipe_gift y pipe_splice en una cadena de pipes. Uso: test_splice <KB>\n", 0},
+	{"test_poll", testPollCmd, ": Un proceso atiende varios pipes con poll. Uso: test_poll <escritores>\n", 0},
+	{"test_nonblock", testNonblockCmd, ": Pasa datos por un pipe con sus dos puntas en O_NONBLOCK. Uso: test_nonblock <KB>\n", 0},
 	{"exceptions", exceptionCmd,
 	 ": Testear excepciones. Ingrese: exceptions [zero/invalidOpcode] para testear alguna operacion\n", 1},
 	{"mmtype", mmTypeCmd, ": Muestra el tipo de memory manager activo\n", 0},
@@ -23,8 +29,15 @@ const TShellCmd shellCmds[] = {
 	{"loop", loopCmd, ": Crea un proceso que imprime su ID con saludo cada X segundos. Uso: loop <segundos>\n", 0},
 	{"kill", killCmd, ": Mata un proceso por PID. Uso: kill <pid>\n", 1},
 	{"nice", niceCmd, ": Cambia la prioridad de un proceso. Uso: nice <pid> <prioridad>\n", 1},
+	{"quota", quotaCmd, ": Limita la memoria de usuario de un proceso (0 = sin limite). Uso: quota <pid> <bytes>\n", 1},
 	{"block", blockCmd, ": Cambia el estado de un proceso entre bloqueado y listo. Uso: block <pid>\n", 1},
 	{"mem", memCmd, ": Imprime el estado de la memoria\n", 0},
+	{"memprof", memprofCmd,
+	 ": Profiler de allocaciones del kernel. Uso: memprof [on|off] | memprof [top N] | memprof log [N]\n", 1},
+	{"mmheap", mmheapCmd,
+	 ": Muestra los heaps del kernel o cambia el heap de un uso. Uso: mmheap [<general|stacks|pages|user> <heap>]\n", 1},
+	{"paging", pagingCmd, ": Muestra el estado de la paginacion o prende/apaga PCID. Uso: paging [pcid on|off]\n", 1},
+	{"slabinfo", slabinfoCmd, ": Muestra la ocupacion de cada cache del slab allocator del kernel\n", 0},
 	{"cat", catCmd, ": Imprime el stdin tal como lo recibe\n", 0},
 	{"wc", wcCmd, ": Cuenta la cantidad de lineas del input\n", 0},
 	{"filter", filterCmd, ": Filtra las vocales del input\n", 0},
@@ -130,6 +130,114 @@ int niceCmd(int argc, char *argv[]) {
 	return OK;
 }
 
+int quotaCmd(int argc, char *argv[]) {
+	if (argc != 3) {
+		printf("Uso: quota <pid> <bytes>\n");
+		return CMD_ERROR;
+	}
+
+	int64_t pid = atoi(argv[1]);
+	if (pid <= 0) {
+		printf("Error: PID invalido.\n");
+		return CMD_ERROR;
+	}
+
+	int bytes = atoi(argv[2]);
+	if (bytes < 0) {
+		printf("Error: la cuota debe ser 0 (sin limite) o una cantidad de bytes.\n");
+		return CMD_ERROR;
+	}
+
+	if (set_mem_quota(pid, (uint64_t) bytes) == 0) {
+		printf("Error: no se pudo fijar la cuota del proceso %lld.\n", pid);
+		return CMD_ERROR;
+	}
+
+	if (bytes == 0) {
+		printf("Proceso %lld sin limite de memoria.\n", pid);
+	}
+	else {
+		printf("Cuota del proceso %lld fijada en %d bytes.\n", pid, bytes);
+	}
+	return OK;
+}
+
+#define MEMPROF_DEFAULT_ROWS 10
+#define MEMPROF_MAX_ROWS 32
+
+static void memprof_print_sites(uint64_t rows) {
+	memprof_status_t status;
+	if (memprof_status(&status) == 0) {
+		printf("Error: no se pudo leer el estado del profiler.\n");
+		return;
+	}
+	printf("Profiler %s: %llu eventos, %llu sitios, %llu bloques sin rastrear\n",
+		   status.enabled ? "encendido" : "apagado", status.events, status.sites, status.untracked);
+
+	memprof_site_t sites[MEMPROF_MAX_ROWS];
+	uint64_t count = memprof_sites(sites, rows);
+	if (count == 0) {
+		printf("Sin allocaciones registradas (memprof on para empezar).\n");
+		return;
+	}
+
+	printf("\nSitio\t\t\tPID\tVivos\t\tBloques\tPico\t\tAllocs\tFrees\n");
+	for (uint64_t i = 0; i < count; i++) {
+		printf("0x%llx\t\t%llu\t%llu\t\t%llu\t%llu\t\t%llu\t%llu\n", sites[i].caller, sites[i].pid,
+			   sites[i].live_bytes, sites[i].live_blocks, sites[i].peak_bytes, sites[i].allocations, sites[i].frees);
+	}
+}
+
+static void memprof_print_events(uint64_t rows) {
+	memprof_event_t events[MEMPROF_MAX_ROWS];
+	uint64_t count = memprof_events(events, rows);
+	if (count == 0) {
+		printf("No hay eventos en el ring buffer.\n");
+		return;
+	}
+
+	printf("Tick\tPID\tOp\tSitio\t\t\tBloque\t\t\tBytes\n");
+	for (uint64_t i = 0; i < count; i++) {
+		printf("%llu\t%llu\t%s\t0x%llx\t\t0x%llx\t\t%llu\n", events[i].ticks, events[i].pid,
+			   events[i].is_free ? "free" : "alloc", events[i].caller, events[i].ptr, events[i].size);
+	}
+}
+
+int memprofCmd(int argc, char *argv[]) {
+	if (argc == 2 && strcmp(argv[1], "on") == 0) {
+		memprof_enable(1);
+		printf("Profiler de memoria encendido (contadores reiniciados).\n");
+		return OK;
+	}
+	if (argc == 2 && strcmp(argv[1], "off") == 0) {
+		memprof_enable(0);
+		printf("Profiler de memoria apagado; el reporte conserva lo registrado.\n");
+		return OK;
+	}
+
+	uint64_t rows = MEMPROF_DEFAULT_ROWS;
+	if (argc == 3) {
+		int n = atoi(argv[2]);
+		if (n <= 0) {
+			printf("Error: la cantidad de filas debe ser positiva.\n");
+			return CMD_ERROR;
+		}
+		rows = (n > MEMPROF_MAX_ROWS) ? MEMPROF_MAX_ROWS : (uint64_t) n;
+	}
+
+	if (argc == 1 || (argc == 3 && strcmp(argv[1], "top") == 0)) {
+		memprof_print_sites(rows);
+		return OK;
+	}
+	if ((argc == 2 || argc == 3) && strcmp(argv[1], "log") == 0) {
+		memprof_print_events(rows);
+		return OK;
+	}
+
+	printf("Uso: memprof [on|off] | memprof [top N] | memprof log [N]\n");
+	return CMD_ERROR;
+}
+
 int blockCmd(int argc, char *argv[]) {
 	if (argc != 2) {
 		printf("Uso: block <pid>\n");
@@ -187,3 +295,90 @@ int blockCmd(int argc, char *argv[]) {
 
 	return OK;
 }
+
+static const char *heap_use_names[HEAP_USE_COUNT] = {"general", "stacks", "pages", "user"};
+
+static int heap_use_by_name(const char *name) {
+	for (int i = 0; i < HEAP_USE_COUNT; i++) {
+		if (strcmp(heap_use_names[i], name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+int mmheapCmd(int argc, char *argv[]) {
+	heap_info_t heaps[MAX_HEAP_INFO];
+	uint64_t count = heap_info(heaps, MAX_HEAP_INFO);
+	if (count == 0) {
+		printf("Error: no se pudo leer la informacion de los heaps.\n");
+		return CMD_ERROR;
+	}
+
+	if (argc == 1) {
+		printf("Heap\tBackend\tUsados\t\tTotal\t\tUsos\n");
+		for (uint64_t i = 0; i < count; i++) {
+			printf("%llu\t%s\t%llu\t\t%llu\t", i, heaps[i].name, heaps[i].stats.used_bytes,
+				   heaps[i].stats.total_bytes);
+			for (int u = 0; u < HEAP_USE_COUNT; u++) {
+				if (heaps[i].uses & (1ULL << u))
+					printf(" %s", heap_use_names[u]);
+			}
+			printf("\n");
+		}
+		return OK;
+	}
+
+	if (argc != 3) {
+		printf("Uso: mmheap | mmheap <general|stacks|pages|user> <heap>\n");
+		return CMD_ERROR;
+	}
+
+	int use = heap_use_by_name(argv[1]);
+	if (use < 0) {
+		printf("Error: uso invalido (general, stacks, pages o user).\n");
+		return CMD_ERROR;
+	}
+	int heap = -1;
+	for (uint64_t i = 0; i < count; i++) {
+		if (strcmp(heaps[i].name, argv[2]) == 0)
+			heap = (int) i;
+	}
+	if (heap < 0 || set_heap_use(use, heap) == 0) {
+		printf("Error: no hay un heap %s.\n", argv[2]);
+		return CMD_ERROR;
+	}
+	printf("Los pedidos %s ahora salen del heap %s.\n", argv[1], argv[2]);
+	return OK;
+}
+
+int pagingCmd(int argc, char *argv[]) {
+	paging_info_t info;
+	if (argc == 1) {
+		if (!paging_status(&info)) {
+			printf("Error: no se pudo leer el estado de la paginacion.\n");
+			return CMD_ERROR;
+		}
+		printf("Paginacion propia: %s\n", info.enabled ? "si" : "no");
+		printf("PCID: %s\n", info.pcid_enabled ? "activo" : (info.pcid_supported ? "apagado" : "no soportado"));
+		printf("Memoria mapeada identidad: %llu MB\n", info.identity_bytes >> 20);
+		printf("Espacios de direcciones: %llu\n", info.address_spaces);
+		printf("Paginas de usuario: %llu\n", info.user_pages);
+		printf("Paginas de tablas: %llu\n", info.table_pages);
+		printf("Cambios de CR3: %llu (vaciando la TLB: %llu)\n", info.switches, info.flushes);
+		printf("Stacks de kernel: %llu con %llu paginas comprometidas (%llu por page fault)\n", info.stacks,
+			   info.stack_pages, info.stack_faults);
+		return OK;
+	}
+
+	if (argc != 3 || strcmp(argv[1], "pcid") != 0 || (strcmp(argv[2], "on") != 0 && strcmp(argv[2], "off") != 0)) {
+		printf("Uso: paging | paging pcid <on|off>\n");
+		return CMD_ERROR;
+	}
+	int on = strcmp(argv[2], "on") == 0;
+	if (!paging_set_pcid(on)) {
+		printf("Error: este procesador no soporta PCID.\n");
+		return CMD_ERROR;
+	}
+	printf("PCID %s.\n", on ? "activado" : "desactivado");
+	return OK;
+}
@@ -186,10 +186,10 @@ int mvarCmd(int argc, char *argv[]) {
 		int64_t pid = my_create_process(name, mvar_writer_entry, process_argv, 1, 0);
 		if (pid <= 0) {
 			printf("Error: no se pudo crear el escritor %c.\n", 'A' + (i % 26));
-			for (int j = 0; j < 6; j++)
-				free(process_argv[j]);
-			free(process_argv);
 		}
+		for (int j = 0; j < 6; j++)
+			free(process_argv[j]);
+		free(process_argv);
 	}
 
 	for (int j = 0; j < num_readers; j++) {
@@ -271,10 +271,10 @@ int mvarCmd(int argc, char *argv[]) {
 		int64_t pid = my_create_process(name, mvar_reader_entry, process_argv, 1, 0);
 		if (pid <= 0) {
 			printf("Error: no se pudo crear el lector %d.\n", j);
-			for (int k = 0; k < 6; k++)
-				free(process_argv[k]);
-			free(process_argv);
 		}
+		for (int k = 0; k < 6; k++)
+			free(process_argv[k]);
+		free(process_argv);
 	}
 
 	printf("Todos los procesos lectores y escritores han sido creados.\n");
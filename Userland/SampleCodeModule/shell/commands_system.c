@@ -56,13 +56,16 @@ int loopCmd(int argc, char *argv[]) {
 	}
 
 	process_argv[0] = seconds_str; 
+	process_argv[1] = NULL;
 
 	int is_foreground = g_run_in_background ? 0 : 1;
 	int64_t pid = execute_external_command("loop_process", loop_process_entry, process_argv, is_foreground, 0, 0);
 
+	// El kernel le copia argv al hijo, asi que la copia del shell se libera siempre
+	free(seconds_str);
+	free(process_argv);
+
 	if (pid <= 0) {
-		free(seconds_str);
-		free(process_argv);
 		printf("Error: no se pudo crear el proceso loop.\n");
 		return CMD_ERROR;
 	}
@@ -107,3 +110,19 @@ int mmTypeCmd(int argc, char *argv[]) {
 
 	return OK;
 }
+
+int slabinfoCmd(int argc, char *argv[]) {
+	int is_foreground = g_run_in_background ? 0 : 1;
+	int64_t pid = execute_external_command("slabinfo", slabinfo_process_entry, NULL, is_foreground, 0, 0);
+
+	if (pid <= 0) {
+		printf("Error: no se pudo crear el proceso slabinfo.\n");
+		return CMD_ERROR;
+	}
+
+	if (g_run_in_background) {
+		printf("Proceso slabinfo creado con PID: %lld (background)\n", pid);
+	}
+
+	return OK;
+}
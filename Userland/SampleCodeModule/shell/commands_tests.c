@@ -84,3 +84,33 @@ int testPriorityCmd(int argc, char *argv[]) {
 	if (argc != 2) { printf("Uso: test_priority <max_value> [&]\n"); return CMD_ERROR; }
 	return launch_test("test_prio", test_prio_wrapper, argc, argv);
 }
+
+int testCtxswCmd(int argc, char *argv[]) {
+	if (argc != 2) { printf("Uso: test_ctxsw <iteraciones> [&]\n"); return CMD_ERROR; }
+	return launch_test("test_ctxsw", test_ctxsw_wrapper, argc, argv);
+}
+
+int testStacksCmd(int argc, char *argv[]) {
+	if (argc != 2) { printf("Uso: test_stacks <procesos> [&]\n"); return CMD_ERROR; }
+	return launch_test("test_stacks", test_stacks_wrapper, argc, argv);
+}
+
+int testPipeCmd(int argc, char *argv[]) {
+	if (argc < 2 || argc > 3) { printf("Uso: test_pipe <KB> [capacidad] [&]\n"); return CMD_ERROR; }
+	return launch_test("test_pipe", test_pipe_wrapper, argc, argv);
+}
+
+int testSpliceCmd(int argc, char *argv[]) {
+	if (argc != 2) { printf("Uso: test_splice <KB> [&]\n"); return CMD_ERROR; }
+	return launch_test("test_splice", test_splice_wrapper, argc, argv);
+}
+
+int testPollCmd(int argc, char *argv[]) {
+	if (argc != 2) { printf("Uso: test_poll <escritores> [&]\n"); return CMD_ERROR; }
+	return launch_test("test_poll", test_poll_wrapper, argc, argv);
+}
+
+int testNonblockCmd(int argc, char *argv[]) {
+	if (argc != 2) { printf("Uso: test_nonblock <KB> [&]\n"); return CMD_ERROR; }
+	return launch_test("test_nonblock", test_nonblock_wrapper, argc, argv);
+}
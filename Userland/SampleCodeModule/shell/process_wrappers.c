@@ -10,6 +10,12 @@ extern int64_t test_mm(uint64_t argc, char *argv[]);
 extern int64_t test_processes(uint64_t argc, char *argv[]);
 extern uint64_t test_prio(uint64_t argc, char *argv[]);
 extern uint64_t test_sync(uint64_t argc, char *argv[]);
+extern uint64_t test_ctxsw(uint64_t argc, char *argv[]);
+extern uint64_t test_stacks(uint64_t argc, char *argv[]);
+extern uint64_t test_pipe(uint64_t argc, char *argv[]);
+extern uint64_t test_splice(uint64_t argc, char *argv[]);
+extern uint64_t test_poll(uint64_t argc, char *argv[]);
+extern uint64_t test_nonblock(uint64_t argc, char *argv[]);
 
 #define STDIN_FD 0
 #define STDOUT_FD 1
@@ -47,8 +53,6 @@ static void test_single_arg_wrapper(void *arg, int64_t (*test_fn)(uint64_t, char
 		args[0] = argv[0];
 		args[1] = NULL;
 		test_fn(1, args);
-		free(argv[0]);
-		free(argv);
 	}
 }
 
@@ -65,9 +69,6 @@ static void test_sync_wrapper_common(void *arg, const char *use_sem) {
 		} else {
 			test_sync(2, args);
 		}
-		free(argv[0]);
-		if (argv[1]) free(argv[1]);
-		free(argv);
 	}
 }
 
@@ -83,6 +84,37 @@ void test_prio_wrapper(void *arg) {
 	test_single_arg_wrapper(arg, (int64_t (*)(uint64_t, char **))test_prio);
 }
 
+void test_ctxsw_wrapper(void *arg) {
+	test_single_arg_wrapper(arg, (int64_t (*)(uint64_t, char **))test_ctxsw);
+}
+
+void test_stacks_wrapper(void *arg) {
+	test_single_arg_wrapper(arg, (int64_t (*)(uint64_t, char **))test_stacks);
+}
+
+void test_pipe_wrapper(void *arg) {
+	char **argv = (char **) arg;
+	if (argv && argv[0]) {
+		char *args[3];
+		args[0] = argv[0];
+		args[1] = argv[1];
+		args[2] = NULL;
+		test_pipe(argv[1] ? 2 : 1, args);
+	}
+}
+
+void test_splice_wrapper(void *arg) {
+	test_single_arg_wrapper(arg, (int64_t (*)(uint64_t, char **))test_splice);
+}
+
+void test_poll_wrapper(void *arg) {
+	test_single_arg_wrapper(arg, (int64_t (*)(uint64_t, char **))test_poll);
+}
+
+void test_nonblock_wrapper(void *arg) {
+	test_single_arg_wrapper(arg, (int64_t (*)(uint64_t, char **))test_nonblock);
+}
+
 void test_sync_wrapper(void *arg) {
 	test_sync_wrapper_common(arg, "1");
 }
@@ -100,8 +132,6 @@ void loop_process_entry(void *arg) {
 		if (seconds <= 0) {
 			seconds = 1; 
 		}
-		free(argv[0]);
-		free(argv);
 	}
 
 	int64_t pid = my_getpid();
@@ -123,9 +153,9 @@ void ps_process_entry(void *arg) {
 		return;
 	}
 
-	printf("\nPID\tNombre\t\t\tEstado\t\tPrioridad\tRSP\t\t\tRBP\t\t\tForeground\n");
+	printf("\nPID\tNombre\t\t\tEstado\t\tPrioridad\tRSP\t\t\tRBP\t\t\tForeground\tMemoria\tStack\n");
 	printf("-----------------------------------------------------------------------------------------------------------"
-		   "----------------\n");
+		   "------------------------\n");
 
 	for (uint64_t i = 0; i < count; i++) {
 		printf("%llu\t", processes[i].pid);
@@ -137,7 +167,9 @@ void ps_process_entry(void *arg) {
 		printf("%d\t\t", processes[i].priority);
 		printf("0x%llx\t", processes[i].rsp);
 		printf("0x%llx\t", processes[i].rbp);
-		printf("%s\n", processes[i].foreground ? "Si" : "No");
+		printf("%s\t\t", processes[i].foreground ? "Si" : "No");
+		printf("%llu KB\t", processes[i].mem_bytes / 1024);
+		printf("%llu KB\n", processes[i].stack_bytes / 1024);
 	}
 
 	printf("\nTotal de procesos: %llu\n", count);
@@ -240,13 +272,6 @@ void mvar_writer_entry(void *arg) {
 		}
 	}
 
-	for (int j = 0; j < 6; j++) {
-		if (argv[j] != NULL) {
-			free(argv[j]);
-		}
-	}
-	free(argv);
-
 	if (!pipe_open(pipe_id)) {
 		return;
 	}
@@ -337,13 +362,6 @@ void mvar_reader_entry(void *arg) {
 		}
 	}
 
-	for (int j = 0; j < 6; j++) {
-		if (argv[j] != NULL) {
-			free(argv[j]);
-		}
-	}
-	free(argv);
-
 	if (!pipe_open(pipe_id)) {
 		return;
 	}
@@ -407,6 +425,28 @@ void mem_process_entry(void *arg) {
 	printf("Asignaciones totales: %llu\n", info.allocations);
 	printf("Liberaciones totales: %llu\n", info.frees);
 	printf("Asignaciones fallidas: %llu\n", info.failed_allocations);
+	printf("Fragmentacion interna: %llu bytes\n", info.internal_fragmentation);
+	printf("Pre-cerada por idle: %llu bytes\n", info.zeroed_bytes);
+	if (info.split_ops || info.merge_ops)
+		printf("Buddy: %llu divisiones, %llu uniones\n", info.split_ops, info.merge_ops);
+
+	process_info_t processes[MAX_PROCESS_INFO];
+	uint64_t count = list_processes(processes, MAX_PROCESS_INFO);
+	uint64_t process_bytes = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		process_bytes += processes[i].mem_bytes;
+	}
+	printf("Memoria de procesos:  %llu bytes en %llu procesos\n", process_bytes, count);
+
+	heap_info_t heaps[MAX_HEAP_INFO];
+	uint64_t heap_count = heap_info(heaps, MAX_HEAP_INFO);
+	if (heap_count > 1) {
+		printf("\nHeaps:\n");
+		for (uint64_t i = 0; i < heap_count; i++) {
+			printf("  %llu %s: %llu de %llu bytes usados\n", i, heaps[i].name, heaps[i].stats.used_bytes,
+				   heaps[i].stats.total_bytes);
+		}
+	}
 
 	if (info.total_bytes > 0) {
 		uint64_t used_percent = (info.used_bytes * 100) / info.total_bytes;
@@ -428,3 +468,33 @@ void mmtype_process_entry(void *arg) {
 		printf("No se pudo obtener el tipo de memory manager\n");
 	}
 }
+
+void slabinfo_process_entry(void *arg) {
+	(void) arg;
+
+	slab_info_t caches[MAX_SLAB_INFO];
+	uint64_t count = slab_info(caches, MAX_SLAB_INFO);
+
+	if (count == 0) {
+		printf("No hay caches de slab creados.\n");
+		return;
+	}
+
+	printf("\nCache\t\tObjeto\tPor slab\tSlabs (llenos/parciales/vacios)\tActivos/Totales\tUso\n");
+	printf("-----------------------------------------------------------------------------------------------\n");
+
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t usage = caches[i].total_objects ? (caches[i].active_objects * 100) / caches[i].total_objects : 0;
+		printf("%s\t", caches[i].name);
+		if (strlen(caches[i].name) < 8) {
+			printf("\t");
+		}
+		printf("%llu\t", caches[i].object_size);
+		printf("%llu\t\t", caches[i].objects_per_slab);
+		printf("%llu/%llu/%llu\t\t\t\t", caches[i].slabs_full, caches[i].slabs_partial, caches[i].slabs_empty);
+		printf("%llu/%llu\t\t", caches[i].active_objects, caches[i].total_objects);
+		printf("%llu%%\n", usage);
+	}
+
+	printf("\n");
+}
@@ -5,6 +5,10 @@
 #include "test_util.h"
 
 #define MAX_BLOCKS 128
+// Latencia de malloc agrupada por cuanto de max_memory estaba asignado al pedir (cuartos)
+#define FILL_BUCKETS 4
+
+extern uint64_t read_tsc(void);
 
 typedef struct MM_rq {
 	void *address;
@@ -16,6 +20,8 @@ uint64_t test_mm(uint64_t argc, char *argv[]) {
 	uint8_t rq;
 	uint32_t total;
 	uint64_t max_memory;
+	uint64_t bucket_cycles[FILL_BUCKETS];
+	uint64_t bucket_count[FILL_BUCKETS];
 
 	if (argc != 1)
 		return -1;
@@ -33,13 +39,19 @@ uint64_t test_mm(uint64_t argc, char *argv[]) {
 		iteration++;
 		rq = 0;
 		total = 0;
+		for (int b = 0; b < FILL_BUCKETS; b++)
+			bucket_cycles[b] = bucket_count[b] = 0;
 
 		printf("Iteracion %llu: ", (unsigned long long) iteration);
 
 		// Request as many blocks as we can
 		while (rq < MAX_BLOCKS && total < max_memory) {
 			mm_rqs[rq].size = GetUniform(max_memory - total - 1) + 1;
+			uint64_t bucket = (uint64_t) total * FILL_BUCKETS / max_memory;
+			uint64_t start = read_tsc();
 			mm_rqs[rq].address = malloc(mm_rqs[rq].size);
+			bucket_cycles[bucket] += read_tsc() - start;
+			bucket_count[bucket]++;
 
 			if (mm_rqs[rq].address) {
 				total += mm_rqs[rq].size;
@@ -53,6 +65,16 @@ uint64_t test_mm(uint64_t argc, char *argv[]) {
 
 		printf("Asignados %llu bloques (%llu bytes) - ", (unsigned long long) rq, (unsigned long long) total);
 
+		// Con bins la latencia deberia quedar pareja aunque el heap se fragmente al llenarse
+		printf("Ciclos por malloc por cuarto de llenado:");
+		for (int b = 0; b < FILL_BUCKETS; b++) {
+			if (bucket_count[b])
+				printf(" %d/%d: %llu", b + 1, FILL_BUCKETS, bucket_cycles[b] / bucket_count[b]);
+			else
+				printf(" %d/%d: -", b + 1, FILL_BUCKETS);
+		}
+		printf(" - ");
+
 		// Set
 		uint32_t i;
 		for (i = 0; i < rq; i++)
@@ -0,0 +1,119 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "lib.h"
+#include "test_util.h"
+#include <stdint.h>
+
+#define CTXSW_WORKERS 2
+#define CTXSW_PAGES 64
+#define CTXSW_PAGE_SIZE 4096
+
+extern uint64_t read_tsc(void);
+
+// Cada vuelta toca todas sus paginas (llena la TLB con su ventana) y cede la CPU
+uint64_t ctxsw_worker(char *argv[]) {
+	int64_t n = satoi(argv[0]);
+	volatile uint8_t *area = (volatile uint8_t *) malloc(CTXSW_PAGES * CTXSW_PAGE_SIZE);
+	if (!area || n <= 0) {
+		printf("test_ctxsw: ERROR en el worker\n");
+		return -1;
+	}
+
+	for (int64_t i = 0; i < n; i++) {
+		for (uint64_t page = 0; page < CTXSW_PAGES; page++)
+			area[page * CTXSW_PAGE_SIZE]++;
+		my_yield();
+	}
+	free((void *) area);
+	return 0;
+}
+
+// Mide el costo de un context switch entre procesos con ventanas de usuario propias (con o sin PCID)
+uint64_t test_ctxsw(uint64_t argc, char *argv[]) {
+	int64_t pids[CTXSW_WORKERS];
+	char *worker_argv[] = {argv[0], NULL};
+	paging_info_t before, after;
+
+	if (argc != 1 || satoi(argv[0]) <= 0)
+		return -1;
+
+	if (!paging_status(&before) || !before.enabled) {
+		printf("test_ctxsw: la paginacion del kernel no esta activa\n");
+		return -1;
+	}
+	printf("PCID: %s\n", before.pcid_enabled ? "activo" : (before.pcid_supported ? "apagado" : "no soportado"));
+
+	uint64_t start = read_tsc();
+	for (int i = 0; i < CTXSW_WORKERS; i++) {
+		pids[i] = my_create_process("ctxsw_worker", ctxsw_worker, worker_argv, 1, 0);
+		if (pids[i] <= 0) {
+			printf("test_ctxsw: ERROR creando proceso\n");
+			return -1;
+		}
+	}
+	for (int i = 0; i < CTXSW_WORKERS; i++)
+		my_wait(pids[i]);
+	uint64_t cycles = read_tsc() - start;
+
+	paging_status(&after);
+	uint64_t switches = after.switches - before.switches;
+	uint64_t flushes = after.flushes - before.flushes;
+	printf("Cambios de CR3: %llu (vaciando la TLB: %llu)\n", switches, flushes);
+	printf("Ciclos totales: %llu\n", cycles);
+	if (switches)
+		printf("Ciclos por cambio: %llu\n", cycles / switches);
+	return 0;
+}
+
+#define STACKS_BATCH 16
+#define STACKS_SETTLE_TRIES 50
+
+uint64_t stacks_exit_worker(char *argv[]) {
+	(void) argv;
+	return 0;
+}
+
+/*
+ * Crea y espera <procesos> procesos que terminan enseguida, de a tandas, y verifica que la cantidad de stacks
+ * de kernel con slot vuelva a la del comienzo: cada stack se libera cuando su proceso ya no esta corriendo.
+ */
+uint64_t test_stacks(uint64_t argc, char *argv[]) {
+	int64_t pids[STACKS_BATCH];
+	paging_info_t before, after;
+
+	if (argc != 1 || satoi(argv[0]) <= 0)
+		return -1;
+	int64_t total = satoi(argv[0]);
+
+	if (!paging_status(&before) || !before.enabled) {
+		printf("test_stacks: la paginacion del kernel no esta activa\n");
+		return -1;
+	}
+
+	for (int64_t done = 0; done < total;) {
+		int batch = 0;
+		for (; batch < STACKS_BATCH && done + batch < total; batch++) {
+			pids[batch] = my_create_process("stacks_exit_worker", stacks_exit_worker, NULL, 1, 0);
+			if (pids[batch] <= 0) {
+				printf("test_stacks: ERROR creando proceso\n");
+				return -1;
+			}
+		}
+		for (int i = 0; i < batch; i++)
+			my_wait(pids[i]);
+		done += batch;
+	}
+
+	// El ultimo en terminar se destruye en un schedule() posterior
+	for (int i = 0; i < STACKS_SETTLE_TRIES; i++) {
+		paging_status(&after);
+		if (after.stacks == before.stacks)
+			break;
+		sleep(10);
+	}
+
+	printf("Procesos creados: %lld\n", total);
+	printf("Stacks de kernel antes: %llu, despues: %llu\n", before.stacks, after.stacks);
+	printf("Paginas de stack antes: %llu, despues: %llu\n", before.stack_pages, after.stack_pages);
+	return after.stacks == before.stacks ? 0 : -1;
+}
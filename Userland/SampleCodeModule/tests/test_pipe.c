@@ -0,0 +1,344 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "lib.h"
+#include "syscall.h"
+#include "test_util.h"
+#include <stdint.h>
+
+#define PIPE_TEST_FD 3
+#define PIPE_TEST_CHUNK 1024
+#define STDIN_FD 0
+#define STDOUT_FD 1
+
+extern uint64_t read_tsc(void);
+
+static uint8_t writer_chunk[PIPE_TEST_CHUNK];
+static uint8_t reader_chunk[PIPE_TEST_CHUNK];
+
+// argv: KB a escribir. Escribe por stdout, que es el pipe; si falla, el test lo ve como bytes de menos
+uint64_t pipe_bw_writer(char *argv[]) {
+	uint64_t total = (uint64_t) satoi(argv[0]) * 1024;
+
+	for (uint64_t sent = 0; sent < total; sent += PIPE_TEST_CHUNK) {
+		if (sys_write(STDOUT_FD, (char *) writer_chunk, PIPE_TEST_CHUNK) != PIPE_TEST_CHUNK)
+			return -1;
+	}
+	return 0;
+}
+
+/*
+ * Mide el ancho de banda de un pipe entre dos procesos que se pasan <KB> kilobytes en bloques de 1 KB.
+ * argv[1] opcional: capacidad del buffer del pipe en bytes.
+ */
+uint64_t test_pipe(uint64_t argc, char *argv[]) {
+	if (argc < 1 || argc > 2 || satoi(argv[0]) <= 0 || (argc == 2 && satoi(argv[1]) <= 0))
+		return -1;
+	uint64_t total = (uint64_t) satoi(argv[0]) * 1024;
+
+	uint64_t pipe_id = pipe_create();
+	// El lector queda abierto antes de crear al escritor para que su primer write no vea el pipe sin lectores
+	if (pipe_id == 0 || !pipe_dup(pipe_id, PIPE_TEST_FD, 0)) {
+		printf("test_pipe: ERROR creando el pipe\n");
+		return -1;
+	}
+	if (argc == 2 && !pipe_set_size(pipe_id, (uint64_t) satoi(argv[1]))) {
+		printf("test_pipe: ERROR cambiando la capacidad del pipe\n");
+		pipe_release_fd(PIPE_TEST_FD);
+		return -1;
+	}
+	printf("Capacidad del pipe: %llu bytes\n", pipe_set_size(pipe_id, 0));
+	char *writer_argv[] = {argv[0], NULL};
+
+	// El escritor nace con el pipe como stdout, asi el primer read no lo ve sin escritores y da EOF
+	uint64_t start = read_tsc();
+	int64_t pid = my_create_process_with_pipes("pipe_bw_writer", pipe_bw_writer, writer_argv, 1, 0, 0, pipe_id);
+	if (pid <= 0) {
+		printf("test_pipe: ERROR creando proceso\n");
+		pipe_release_fd(PIPE_TEST_FD);
+		return -1;
+	}
+
+	uint64_t received = 0;
+	while (received < total) {
+		uint64_t n = sys_read(PIPE_TEST_FD, (char *) reader_chunk, PIPE_TEST_CHUNK);
+		if (n == 0)
+			break;
+		received += n;
+	}
+	uint64_t cycles = read_tsc() - start;
+
+	pipe_release_fd(PIPE_TEST_FD);
+	my_wait(pid);
+
+	printf("Bytes recibidos: %llu de %llu\n", received, total);
+	printf("Ciclos totales: %llu\n", cycles);
+	if (received)
+		printf("Ciclos por KB: %llu\n", cycles / (received / 1024 ? received / 1024 : 1));
+	return received == total ? 0 : -1;
+}
+
+#define SPLICE_READ_FD 3
+#define SPLICE_HOLD_FD 4
+#define SPLICE_GIFT_SIZE 4096
+#define SPLICE_CHUNK (64 * 1024)
+
+static uint8_t stream_byte(uint64_t offset) {
+	return (uint8_t) (offset * 31 + 7);
+}
+
+// argv: KB a escribir. Cada bloque se llena en una region propia y se regala a stdout, que es el primer pipe
+uint64_t splice_gift_writer(char *argv[]) {
+	uint64_t total = (uint64_t) satoi(argv[0]) * 1024;
+
+	for (uint64_t sent = 0; sent < total; sent += SPLICE_GIFT_SIZE) {
+		uint8_t *gift = (uint8_t *) pipe_gift_alloc(SPLICE_GIFT_SIZE);
+		if (!gift)
+			return -1;
+		for (uint64_t i = 0; i < SPLICE_GIFT_SIZE; i++)
+			gift[i] = stream_byte(sent + i);
+		if (pipe_gift(STDOUT_FD, gift, SPLICE_GIFT_SIZE) != SPLICE_GIFT_SIZE) {
+			pipe_gift_free(gift);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// Pasa todo de stdin a stdout (los dos pipes) hasta EOF
+uint64_t splice_worker(char *argv[]) {
+	while (pipe_splice(STDIN_FD, STDOUT_FD, SPLICE_CHUNK) > 0)
+		;
+	return 0;
+}
+
+/*
+ * Cadena escritor -> pipe -> splice -> pipe -> test: el escritor regala regiones al primer pipe, un proceso
+ * las pasa al segundo con pipe_splice y el test lee <KB> kilobytes verificando el contenido.
+ */
+uint64_t test_splice(uint64_t argc, char *argv[]) {
+	if (argc != 1 || satoi(argv[0]) <= 0)
+		return -1;
+	uint64_t total = (uint64_t) satoi(argv[0]) * 1024;
+
+	uint64_t in_id = pipe_create();
+	uint64_t out_id = pipe_create();
+	/*
+	 * Los procesos nacen con los pipes como stdin/stdout, asi sus puntas existen antes de que corran. El test
+	 * sostiene ademas un lector del primer pipe para que el escritor no lo vea sin lectores antes del worker.
+	 */
+	if (in_id == 0 || out_id == 0 || !pipe_dup(out_id, SPLICE_READ_FD, 0) || !pipe_dup(in_id, SPLICE_HOLD_FD, 0)) {
+		printf("test_splice: ERROR creando los pipes\n");
+		return -1;
+	}
+	char *writer_argv[] = {argv[0], NULL};
+	char *worker_argv[] = {NULL};
+
+	uint64_t start = read_tsc();
+	int64_t writer = my_create_process_with_pipes("splice_gift_writer", splice_gift_writer, writer_argv, 1, 0, 0, in_id);
+	int64_t worker = my_create_process_with_pipes("splice_worker", splice_worker, worker_argv, 1, 0, in_id, out_id);
+	if (writer <= 0 || worker <= 0) {
+		printf("test_splice: ERROR creando procesos\n");
+		return -1;
+	}
+
+	uint64_t received = 0;
+	uint64_t errors = 0;
+	while (received < total) {
+		uint64_t n = sys_read(SPLICE_READ_FD, (char *) reader_chunk, PIPE_TEST_CHUNK);
+		if (n == 0)
+			break;
+		for (uint64_t i = 0; i < n; i++) {
+			if (reader_chunk[i] != stream_byte(received + i))
+				errors++;
+		}
+		received += n;
+	}
+	uint64_t cycles = read_tsc() - start;
+
+	pipe_release_fd(SPLICE_HOLD_FD);
+	pipe_release_fd(SPLICE_READ_FD);
+	my_wait(writer);
+	my_wait(worker);
+
+	printf("Bytes recibidos: %llu de %llu (%llu distintos de lo escrito)\n", received, total, errors);
+	printf("Ciclos totales: %llu\n", cycles);
+	if (received)
+		printf("Ciclos por KB: %llu\n", cycles / (received / 1024 ? received / 1024 : 1));
+	return (received == total && errors == 0) ? 0 : -1;
+}
+
+#define POLL_TEST_MAX_WRITERS 8
+#define POLL_TEST_FIRST_FD 3
+#define POLL_TEST_MESSAGES 16
+#define POLL_TEST_MESSAGE 64
+
+// argv: indice del escritor. Escribe por stdout (el pipe) mensajes de su letra, con una pausa distinta por escritor
+uint64_t poll_writer(char *argv[]) {
+	int64_t index = satoi(argv[0]);
+	char message[POLL_TEST_MESSAGE];
+
+	for (int i = 0; i < POLL_TEST_MESSAGE; i++)
+		message[i] = (char) ('a' + index);
+	for (int m = 0; m < POLL_TEST_MESSAGES; m++) {
+		sleep((int) (index + 1) * 20);
+		if (sys_write(STDOUT_FD, message, POLL_TEST_MESSAGE) != POLL_TEST_MESSAGE)
+			return -1;
+	}
+	return 0;
+}
+
+/*
+ * Un solo proceso atiende <escritores> pipes con poll: lee de los que tienen datos y suelta los que se
+ * cerraron, sin ceder la CPU en un loop. Verifica que llegue todo de cada escritor.
+ */
+uint64_t test_poll(uint64_t argc, char *argv[]) {
+	poll_fd_t fds[POLL_TEST_MAX_WRITERS];
+	uint64_t received[POLL_TEST_MAX_WRITERS];
+	int64_t pids[POLL_TEST_MAX_WRITERS];
+	char index_str[POLL_TEST_MAX_WRITERS][4];
+	uint64_t errors = 0;
+
+	if (argc != 1 || satoi(argv[0]) <= 0 || satoi(argv[0]) > POLL_TEST_MAX_WRITERS)
+		return -1;
+	int writers = (int) satoi(argv[0]);
+
+	for (int i = 0; i < writers; i++) {
+		uint64_t pipe_id = pipe_create();
+		if (pipe_id == 0 || !pipe_dup(pipe_id, POLL_TEST_FIRST_FD + i, 0)) {
+			printf("test_poll: ERROR creando los pipes\n");
+			return -1;
+		}
+		fds[i].fd = POLL_TEST_FIRST_FD + i;
+		fds[i].events = POLL_IN;
+		received[i] = 0;
+
+		// El escritor nace con el pipe como stdout, asi el primer poll no lo ve cerrado
+		sprintf(index_str[i], "%d", i);
+		char *writer_argv[] = {index_str[i], NULL};
+		pids[i] = my_create_process_with_pipes("poll_writer", poll_writer, writer_argv, 1, 0, 0, pipe_id);
+		if (pids[i] <= 0) {
+			printf("test_poll: ERROR creando proceso\n");
+			return -1;
+		}
+	}
+
+	uint64_t polls = 0;
+	uint64_t reads = 0;
+	int open = writers;
+	while (open > 0) {
+		int64_t ready = poll(fds, writers, -1);
+		polls++;
+		if (ready <= 0) {
+			printf("test_poll: ERROR en poll\n");
+			break;
+		}
+		for (int i = 0; i < writers; i++) {
+			if (fds[i].revents & POLL_IN) {
+				uint64_t n = sys_read(fds[i].fd, (char *) reader_chunk, PIPE_TEST_CHUNK);
+				for (uint64_t j = 0; j < n; j++) {
+					if (reader_chunk[j] != (uint8_t) ('a' + i))
+						errors++;
+				}
+				received[i] += n;
+				reads++;
+			}
+			else if (fds[i].revents & POLL_HUP) {
+				pipe_release_fd(fds[i].fd);
+				fds[i].fd = -1;
+				open--;
+			}
+		}
+	}
+
+	// Sin fds validos solo puede volver por el tiempo limite
+	int64_t timeout = poll(fds, writers, 100);
+
+	for (int i = 0; i < writers; i++)
+		my_wait(pids[i]);
+
+	uint64_t expected = POLL_TEST_MESSAGES * POLL_TEST_MESSAGE;
+	int ok = (errors == 0 && timeout == 0);
+	for (int i = 0; i < writers; i++) {
+		printf("Escritor %d: %llu de %llu bytes\n", i, received[i], expected);
+		if (received[i] != expected)
+			ok = 0;
+	}
+	printf("Llamadas a poll: %llu, lecturas: %llu, bytes distintos de lo escrito: %llu\n", polls, reads, errors);
+	printf("Poll sin fds con timeout de 100 ms: %lld\n", timeout);
+	return ok ? 0 : -1;
+}
+
+#define NONBLOCK_READ_FD 3
+#define NONBLOCK_WRITE_FD 4
+#define NONBLOCK_READ_CHUNK 700 // menos de lo que se escribe por vuelta, asi el pipe se llena
+
+/*
+ * Un solo proceso tiene las dos puntas de un pipe en modo O_NONBLOCK y le pasa <KB> kilobytes: escribe lo
+ * que entra y lee lo que hay, alternando, sin bloquearse aunque lo escrito supere la capacidad del pipe.
+ */
+uint64_t test_nonblock(uint64_t argc, char *argv[]) {
+	if (argc != 1 || satoi(argv[0]) <= 0)
+		return -1;
+	uint64_t total = (uint64_t) satoi(argv[0]) * 1024;
+
+	uint64_t pipe_id = pipe_create();
+	if (pipe_id == 0 || !pipe_dup(pipe_id, NONBLOCK_READ_FD, 0) || !pipe_dup(pipe_id, NONBLOCK_WRITE_FD, 1) ||
+		fcntl(NONBLOCK_READ_FD, F_SETFL, O_NONBLOCK) != 0 || fcntl(NONBLOCK_WRITE_FD, F_SETFL, O_NONBLOCK) != 0) {
+		printf("test_nonblock: ERROR creando el pipe\n");
+		return -1;
+	}
+
+	int ok = 1;
+	if (sys_read(NONBLOCK_READ_FD, (char *) reader_chunk, 1) != WOULD_BLOCK) {
+		printf("test_nonblock: ERROR, leer el pipe vacio no devolvio WOULD_BLOCK\n");
+		ok = 0;
+	}
+
+	uint64_t sent = 0;
+	uint64_t received = 0;
+	uint64_t errors = 0;
+	uint64_t write_blocks = 0;
+	uint64_t read_blocks = 0;
+	uint64_t start = read_tsc();
+	while (ok && received < total) {
+		if (sent < total) {
+			uint64_t n = total - sent < PIPE_TEST_CHUNK ? total - sent : PIPE_TEST_CHUNK;
+			for (uint64_t i = 0; i < n; i++)
+				writer_chunk[i] = stream_byte(sent + i);
+			uint64_t w = sys_write(NONBLOCK_WRITE_FD, (char *) writer_chunk, n);
+			if (w == WOULD_BLOCK)
+				write_blocks++;
+			else
+				sent += w;
+		}
+		uint64_t r = sys_read(NONBLOCK_READ_FD, (char *) reader_chunk, NONBLOCK_READ_CHUNK);
+		if (r == WOULD_BLOCK) {
+			read_blocks++;
+			continue;
+		}
+		if (r == 0) {
+			printf("test_nonblock: ERROR, EOF con el escritor abierto\n");
+			ok = 0;
+			break;
+		}
+		for (uint64_t i = 0; i < r; i++) {
+			if (reader_chunk[i] != stream_byte(received + i))
+				errors++;
+		}
+		received += r;
+	}
+	uint64_t cycles = read_tsc() - start;
+
+	// Sin escritores el pipe vacio da EOF aunque el lector no bloquee
+	pipe_release_fd(NONBLOCK_WRITE_FD);
+	if (ok && sys_read(NONBLOCK_READ_FD, (char *) reader_chunk, 1) != 0) {
+		printf("test_nonblock: ERROR, sin escritores no se leyo EOF\n");
+		ok = 0;
+	}
+	pipe_release_fd(NONBLOCK_READ_FD);
+
+	printf("Bytes recibidos: %llu de %llu (%llu distintos de lo escrito)\n", received, total, errors);
+	printf("Escrituras sin lugar: %llu, lecturas sin datos: %llu\n", write_blocks, read_blocks);
+	printf("Ciclos totales: %llu\n", cycles);
+	return (ok && received == total && errors == 0) ? 0 : -1;
+}
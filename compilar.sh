@@ -19,7 +19,7 @@ if [ $? -ne 0 ]; then
     fi
 fi
 
-# Permite elegir el memory manager: simple (default) o buddy
+# Permite elegir el memory manager: simple (default), buddy o tlsf
 # Uso: ./compilar.sh buddy   o  ./compilar.sh MM=buddy
 ARG=${1:-simple}
 if [[ "$ARG" == MM=* ]]; then